@@ -0,0 +1,88 @@
+#ifndef PROJET_BIOINFO_WIRTH_ALPHABET_H
+#define PROJET_BIOINFO_WIRTH_ALPHABET_H
+
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Encodage des acides aminés en entiers (séquences "digitalisées"), par une table de 256 entrées calculée à la
+ * compilation. Les minuscules ont le code de la majuscule correspondante.
+ *  - 0 à 19 : les 20 acides aminés, dans l'ordre des colonnes des matrices d'émission : A C D E F G H I K L M N P Q R S
+ *    T V W Y ;
+ *  - gap : '-' et '.' ;
+ *  - B (D ou N), Z (E ou Q), J (I ou L), U (sélénocystéine, traitée comme C), O (pyrrolysine, traitée comme K) ;
+ *  - X : acide aminé inconnu, et tout autre caractère.
+ */
+struct Alphabet {
+    // Nombre d'acides aminés
+    static constexpr std::size_t size = 20;
+    static constexpr std::uint8_t gap = 20;
+    static constexpr std::uint8_t B = 21;
+    static constexpr std::uint8_t Z = 22;
+    static constexpr std::uint8_t J = 23;
+    static constexpr std::uint8_t U = 24;
+    static constexpr std::uint8_t O = 25;
+    static constexpr std::uint8_t X = 26;
+    // Nombre de codes
+    static constexpr std::size_t codes = 27;
+    // Caractère de chaque acide aminé
+    static constexpr char residues[size + 1] = "ACDEFGHIKLMNPQRSTVWY";
+
+    static constexpr std::array<std::uint8_t, 256> table = []() {
+        std::array<std::uint8_t, 256> table{};
+        for (auto & code : table) {
+            code = X;
+        }
+        for (std::uint8_t code = 0; code < size; code++) {
+            table[static_cast<unsigned char>(residues[code])] = code;
+            table[static_cast<unsigned char>(residues[code] - 'A' + 'a')] = code;
+        }
+        const char degenerate[] = {'B', 'Z', 'J', 'U', 'O'};
+        for (std::uint8_t i = 0; i < 5; i++) {
+            table[static_cast<unsigned char>(degenerate[i])] = B + i;
+            table[static_cast<unsigned char>(degenerate[i] - 'A' + 'a')] = B + i;
+        }
+        table['-'] = gap;
+        table['.'] = gap;
+        return table;
+    }();
+
+    // Code d'un caractère
+    static std::uint8_t digitize(char c) {
+        return table[static_cast<unsigned char>(c)];
+    }
+
+    // Caractère d'un acide aminé (code inférieur à size)
+    static char residue(std::size_t code) {
+        return residues[code];
+    }
+
+    /**
+     * Acides aminés représentés par un code
+     * @param code un code autre que gap
+     * @return la liste des codes d'acides aminés (le code lui-même pour un acide aminé, les 20 pour X)
+     */
+    static std::vector<std::uint8_t> members(std::uint8_t code) {
+        switch (code) {
+            case B: return {2, 11};
+            case Z: return {3, 13};
+            case J: return {7, 9};
+            case U: return {1};
+            case O: return {8};
+            case X: {
+                std::vector<std::uint8_t> all(size);
+                for (std::uint8_t a = 0; a < size; a++) {
+                    all[a] = a;
+                }
+                return all;
+            }
+            default: return {code};
+        }
+    }
+};
+
+
+#endif //PROJET_BIOINFO_WIRTH_ALPHABET_H
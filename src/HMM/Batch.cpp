@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include "Batch.h"
+#include "Stats.h"
+
+namespace {
+
+// Résultat d'un enregistrement, dans le format demandé
+std::string format_record(const HMM& hmm, std::string_view header, const std::vector<char>& sequence,
+                          const HMM::AlignOptions& options, Output::Format format) {
+    Output out;
+    if (format == Output::Format::text) {
+        out << '>' << header << '\n' << hmm.align(sequence, options);
+        return out.str();
+    }
+    // Hors du mode global, une ligne par domaine, suivie de ses coordonnées
+    const bool global = options.mode == HMM::Mode::global;
+    const std::vector<HMM::Alignment> hits = hmm.align_hits(sequence, options);
+    for (const auto & alignment : hits) {
+        const bool coordinates = not global && not options.score;
+        if (format == Output::Format::tsv) {
+            out << header << '\t' << alignment.score << '\t' << alignment.sequence << '\t' << alignment.states;
+            if (coordinates) {
+                out << '\t' << alignment.sequence_begin << '\t' << alignment.sequence_end << '\t'
+                    << alignment.model_begin << '\t' << alignment.model_end;
+            }
+            out << '\n';
+            continue;
+        }
+        out << "{\"header\":";
+        out.json(header);
+        out << ",\"score\":";
+        out.json(alignment.score);
+        if (not options.score) {
+            out << ",\"sequence\":";
+            out.json(alignment.sequence);
+            out << ",\"states\":";
+            out.json(alignment.states);
+        }
+        if (coordinates) {
+            out << ",\"sequence_begin\":" << alignment.sequence_begin << ",\"sequence_end\":" << alignment.sequence_end
+                << ",\"model_begin\":" << alignment.model_begin << ",\"model_end\":" << alignment.model_end;
+        }
+        out << "}\n";
+    }
+    return out.str();
+}
+
+}
+
+Batch::Batch(const HMM& hmm, unsigned threads)
+:hmm_(hmm),
+threads_(threads != 0 ? threads : std::max(1u, std::thread::hardware_concurrency()))
+{
+}
+
+void Batch::run(const Fasta& fasta, const HMM::AlignOptions& options, Output::Format format,
+                std::ostream& stream) const {
+    HMM::check_options(options);
+    // Fenêtre de résultats en attente d'écriture : les threads ne prennent pas d'avance au delà, ce qui borne la
+    // mémoire utilisée lorsqu'une séquence longue bloque l'écriture des suivantes
+    const std::size_t window = 16 * threads_;
+    std::vector<std::string> slots(window);
+    std::vector<bool> ready(window, false);
+    // Enregistrements lus au fil de l'eau : next est l'indice du prochain, total leur nombre une fois le fichier lu
+    auto record = fasta.begin();
+    std::size_t next = 0;
+    std::size_t total = SIZE_MAX;
+    std::size_t written = 0;
+    std::mutex mutex;
+    std::condition_variable cv;
+    // Première erreur d'un thread : les autres s'arrêtent, et elle est relancée après leur fin
+    std::exception_ptr failure;
+
+    auto work = [&]() {
+        std::vector<char> sequence;
+        while (true) {
+            std::size_t index;
+            Fasta::View view;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [&]() { return failure || record == fasta.end() || next < written + window; });
+                if (failure) {
+                    return;
+                }
+                if (record == fasta.end()) {
+                    total = next;
+                    cv.notify_all();
+                    return;
+                }
+                Stats::Timer timer(Stats::Stage::parse);
+                view = *record++;
+                index = next++;
+            }
+            {
+                Stats::Timer timer(Stats::Stage::parse);
+                sequence.clear();
+                view.copy_residues(sequence);
+            }
+            Stats::add(Stats::Counter::sequences, 1);
+            std::string result = format_record(hmm_, view.header, sequence, options, format);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                slots[index % window] = std::move(result);
+                ready[index % window] = true;
+            }
+            cv.notify_all();
+        }
+    };
+    auto worker = [&]() {
+        try {
+            work();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (not failure) {
+                failure = std::current_exception();
+            }
+            cv.notify_all();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < threads_; i++) {
+        workers.emplace_back(worker);
+    }
+    Output out(stream);
+    // Écriture dans l'ordre d'entrée, dès que le résultat suivant est prêt
+    for (std::size_t index = 0; ; index++) {
+        std::string result;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [&]() { return failure || ready[index % window] || index >= total; });
+            if (failure || index >= total) {
+                break;
+            }
+            result = std::move(slots[index % window]);
+            ready[index % window] = false;
+            written = index + 1;
+        }
+        cv.notify_all();
+        out << result;
+    }
+    for (auto & thread : workers) {
+        thread.join();
+    }
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+    out.flush();
+}
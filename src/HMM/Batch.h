@@ -0,0 +1,42 @@
+#ifndef PROJET_BIOINFO_WIRTH_BATCH_H
+#define PROJET_BIOINFO_WIRTH_BATCH_H
+
+
+#include <ostream>
+#include <vector>
+#include "Fasta.h"
+#include "HMM.h"
+#include "Output.h"
+
+/**
+ * Alignement de tous les enregistrements d'un fasta sur un même modèle, réparti sur plusieurs threads.
+ * Les résultats sont écrits dans l'ordre du fichier d'entrée, au fur et à mesure qu'ils sont disponibles.
+ */
+class Batch {
+public:
+    /**
+     * @param hmm le modèle chargé, partagé en lecture par tous les threads
+     * @param threads nombre de threads de calcul (0 : autant que de coeurs)
+     */
+    Batch(const HMM& hmm, unsigned threads);
+
+    /**
+     * Aligne chaque enregistrement et écrit, pour chacun, l'en-tête puis le résultat de HMM::align (format texte), ou
+     * une ligne : en-tête, score, séquence alignée et séquence d'états, séparés par des tabulations (tsv) ou dans un
+     * objet JSON (json ; sans séquences avec l'option score, et un score null s'il est -inf). Hors du mode global, une
+     * ligne par domaine trouvé (aucune sans domaine), complétée des coordonnées du domaine (sauf option score).
+     * Les enregistrements sont lus au fil de l'eau : seuls ceux en cours de calcul ou d'écriture sont en mémoire.
+     * @param fasta le fichier des séquences à aligner
+     * @param options options de l'alignement
+     * @param format le format des résultats
+     * @param out le flux de sortie, écrit par blocs
+     */
+    void run(const Fasta& fasta, const HMM::AlignOptions& options, Output::Format format, std::ostream& out) const;
+
+private:
+    const HMM& hmm_;
+    unsigned threads_;
+};
+
+
+#endif //PROJET_BIOINFO_WIRTH_BATCH_H
@@ -0,0 +1,53 @@
+#ifndef PROJET_BIOINFO_WIRTH_BINARYMODEL_H
+#define PROJET_BIOINFO_WIRTH_BINARYMODEL_H
+
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Format binaire des fichiers modèle, projetable en mémoire (mmap) et lu sans copie. Un modèle qui ne commence pas sur
+ * 64 octets (après un modèle texte dans une bibliothèque, ou lu d'un tube) est copié dans une zone alignée.
+ * Un en-tête de 64 octets, suivi de tableaux de float (dans l'ordre des octets de la machine), chacun aligné sur 64
+ * octets :
+ *  - T (N x 9), e_M (N x 20, première ligne à NaN), e_I (N x 20), probabilités arrondies comme dans le format texte ;
+ *  - si flags & with_profile : les logarithmes du profil compilé (voir Profile), transitions (N x 9), émissions M
+ *    (N x 32) puis I (N x 32), indexées par la séquence digitalisée (voir Alphabet).
+ * La version 1 stockait les émissions du profil sur 20 colonnes : à la lecture, le profil en est recompilé.
+ * La somme de contrôle (FNV-1a 64 bits) porte sur tout ce qui suit l'en-tête.
+ */
+struct BinaryModel {
+    static constexpr char magic[8] = {'H', 'M', 'M', 'M', 'O', 'D', 'E', 'L'};
+    static constexpr std::uint32_t version = 2;
+    static constexpr std::uint32_t with_profile = 1;
+    static constexpr std::size_t alignment = 64;
+
+    struct Header {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t alphabet_size;
+        std::uint64_t size;
+        std::uint32_t flags;
+        std::uint32_t reserved;
+        std::uint64_t checksum;
+        char padding[24];
+    };
+    static_assert(sizeof(Header) == alignment, "l'en-tête occupe exactement 64 octets");
+
+    // Taille en octets d'un tableau de count float, complété jusqu'au prochain multiple de 64
+    static std::size_t section_size(std::size_t count) {
+        return (count * sizeof(float) + alignment - 1) / alignment * alignment;
+    }
+
+    // Somme de contrôle FNV-1a 64 bits
+    static std::uint64_t checksum(const char *data, std::size_t size) {
+        std::uint64_t hash = 14695981039346656037ULL;
+        for (std::size_t i = 0; i < size; i++) {
+            hash = (hash ^ static_cast<unsigned char>(data[i])) * 1099511628211ULL;
+        }
+        return hash;
+    }
+};
+
+
+#endif //PROJET_BIOINFO_WIRTH_BINARYMODEL_H
@@ -2,29 +2,125 @@
 // Created by felix on 09/07/22.
 //
 
+#include <cstring>
+#include "Alphabet.h"
 #include "Fasta.h"
 
+namespace {
+
+// Fin de la ligne commençant en line (le '\n' ou la fin du fichier)
+const char *end_of_line(const char *line, const char *end) {
+    const auto *found = static_cast<const char *>(std::memchr(line, '\n', static_cast<std::size_t>(end - line)));
+    return found != nullptr ? found : end;
+}
+
+// Caractère ignoré dans une séquence
+bool is_blank(char c) {
+    return c == '\n' || c == '\r' || c == ' ' || c == '\t';
+}
+
+}
+
 Fasta::Fasta(const std::string& filename):
-file_(filename){
+file_(std::make_shared<const MappedFile>(filename)){
 }
 
-std::vector<std::vector<char>> Fasta::parse() {
+Fasta::iterator Fasta::begin() const {
+    return {file_->data(), file_->data() + file_->size()};
+}
+
+Fasta::iterator Fasta::end() const {
+    const char *end = file_->data() + file_->size();
+    return {end, end};
+}
+
+std::vector<std::vector<char>> Fasta::parse() const {
     std::vector<std::vector<char>> sequences;
-    std::string line;
-    std::vector<char> sequence;
-    while (getline(this->file_, line)) {
-        if (line.find('>') != std::string::npos) {
-            if (not sequence.empty()) {
-                sequences.emplace_back(sequence);
-            }
-            sequence.clear();
+    for (const auto & record : *this) {
+        sequences.emplace_back();
+        record.copy_residues(sequences.back());
+    }
+    return sequences;
+}
+
+std::vector<Fasta::Record> Fasta::parse_records() const {
+    std::vector<Record> records;
+    for (const auto & record : *this) {
+        records.push_back({std::string(record.header), {}});
+        record.copy_residues(records.back().sequence);
+    }
+    return records;
+}
+
+void Fasta::View::copy_residues(std::vector<char>& sequence) const {
+    for (char c : residues) {
+        if (not is_blank(c)) {
+            sequence.push_back(c);
         }
-        else {
-            copy(line.begin(), line.end(), back_inserter(sequence));
+    }
+}
+
+void Fasta::View::digitize(std::vector<std::uint8_t>& codes) const {
+    for (char c : residues) {
+        if (not is_blank(c)) {
+            codes.push_back(Alphabet::digitize(c));
         }
     }
-    if (not sequence.empty()) {
-        sequences.emplace_back(sequence);
+}
+
+Fasta::iterator::iterator(const char *position, const char *end)
+:next_(position),
+end_(end)
+{
+    read();
+}
+
+Fasta::iterator& Fasta::iterator::operator++() {
+    read();
+    return *this;
+}
+
+Fasta::iterator Fasta::iterator::operator++(int) {
+    iterator copy = *this;
+    read();
+    return copy;
+}
+
+void Fasta::iterator::read() {
+    while (next_ < end_) {
+        position_ = next_;
+        const char *line_end = end_of_line(next_, end_);
+        const auto *chevron = static_cast<const char *>(std::memchr(next_, '>', static_cast<std::size_t>(line_end - next_)));
+        // En-tête : la suite de la ligne après le '>'. Des lignes avant le premier en-tête forment un enregistrement
+        // sans en-tête.
+        const char *residues = next_;
+        view_.header = {};
+        if (chevron != nullptr) {
+            const char *header_end = line_end;
+            if (header_end > chevron + 1 && header_end[-1] == '\r') {
+                header_end--;
+            }
+            view_.header = std::string_view(chevron + 1, static_cast<std::size_t>(header_end - chevron - 1));
+            residues = line_end < end_ ? line_end + 1 : end_;
+        }
+        // Lignes de séquence, jusqu'au prochain en-tête
+        const char *residues_end = residues;
+        bool empty = true;
+        while (residues_end < end_) {
+            line_end = end_of_line(residues_end, end_);
+            if (std::memchr(residues_end, '>', static_cast<std::size_t>(line_end - residues_end)) != nullptr) {
+                break;
+            }
+            for (const char *c = residues_end; empty && c < line_end; c++) {
+                empty = is_blank(*c);
+            }
+            residues_end = line_end < end_ ? line_end + 1 : end_;
+        }
+        view_.residues = std::string_view(residues, static_cast<std::size_t>(residues_end - residues));
+        next_ = residues_end;
+        if (not empty) {
+            return;
+        }
     }
-    return sequences;
+    position_ = end_;
 }
@@ -6,16 +6,102 @@
 #define PROJET_BIOINFO_WIRTH_FASTA_H
 
 
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
 #include <string>
-#include <fstream>
+#include <string_view>
 #include <vector>
+#include "MappedFile.h"
 
+/**
+ * Lecture d'un fichier fasta projeté en mémoire. Les enregistrements sont parcourus un à un par itérateur, sans copie
+ * ni allocation : la mémoire utilisée ne dépend pas de la taille du fichier.
+ * Une ligne contenant un '>' commence un enregistrement, son en-tête est la suite de la ligne. Les enregistrements sans
+ * caractère sont ignorés.
+ */
 class Fasta {
 public:
+    /**
+     * Enregistrement d'un fichier fasta : l'en-tête (sans le '>') et la séquence associée
+     */
+    struct Record {
+        std::string header;
+        std::vector<char> sequence;
+    };
+
+    /**
+     * Vue sur un enregistrement, valable tant que le Fasta existe
+     */
+    struct View {
+        // En-tête, sans le '>' ni le retour à la ligne
+        std::string_view header;
+        // Lignes de la séquence, telles que dans le fichier (retours à la ligne compris)
+        std::string_view residues;
+
+        /**
+         * Copie des caractères de la séquence (sans les retours à la ligne ni les blancs) à la fin de sequence
+         * @param sequence le tampon de destination, réutilisable d'un enregistrement à l'autre
+         */
+        void copy_residues(std::vector<char>& sequence) const;
+
+        /**
+         * Digitalisation de la séquence (sans les retours à la ligne ni les blancs) à la fin de codes
+         * @param codes le tampon de destination, réutilisable d'un enregistrement à l'autre
+         * @see Alphabet
+         */
+        void digitize(std::vector<std::uint8_t>& codes) const;
+    };
+
+    /**
+     * Itérateur sur les enregistrements
+     */
+    class iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = View;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const View *;
+        using reference = const View &;
+
+        iterator() = default;
+        iterator(const char *position, const char *end);
+        reference operator*() const { return view_; }
+        pointer operator->() const { return &view_; }
+        iterator& operator++();
+        iterator operator++(int);
+        bool operator==(const iterator& other) const { return position_ == other.position_; }
+        bool operator!=(const iterator& other) const { return position_ != other.position_; }
+
+    private:
+        // Lecture de l'enregistrement suivant à partir de next_ (position_ vaut end_ s'il n'y en a plus)
+        void read();
+        const char *position_{};
+        const char *next_{};
+        const char *end_{};
+        View view_;
+    };
+
+    /**
+     * @param filename le fichier fasta
+     * @throws std::runtime_error si le fichier ne peut pas être ouvert
+     */
     explicit Fasta(const std::string& filename);
-    std::vector<std::vector<char>> parse();
+    [[nodiscard]] iterator begin() const;
+    [[nodiscard]] iterator end() const;
+    /**
+     * Copie de toutes les séquences du fichier
+     * @return la liste des séquences non vides, dans l'ordre du fichier
+     */
+    [[nodiscard]] std::vector<std::vector<char>> parse() const;
+    /**
+     * Copie de tous les enregistrements du fichier, en conservant les en-têtes
+     * @return la liste des enregistrements non vides, dans l'ordre du fichier
+     */
+    [[nodiscard]] std::vector<Record> parse_records() const;
 private:
-    std::ifstream file_;
+    std::shared_ptr<const MappedFile> file_;
 };
 
 
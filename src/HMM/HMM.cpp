@@ -2,77 +2,130 @@
 // Created by felix on 09/07/22.
 //
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
 #include <iostream>
-#include <iomanip>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
 #include <utility>
 #include <valarray>
+#include "Alphabet.h"
+#include "BinaryModel.h"
 #include "HMM.h"
-
-std::map<const char, std::size_t> HMM::alphabet = {{'A', 0}, {'C', 1}, {'D', 2}, {'E', 3},
-                                                        {'F', 4}, {'G', 5}, {'H', 6}, {'I', 7},
-                                                        {'K', 8}, {'L', 9}, {'M', 10}, {'N', 11},
-                                                        {'P', 12}, {'Q', 13}, {'R', 14},
-                                                        {'S', 15}, {'T', 16}, {'V', 17},
-                                                        {'W', 18}, {'Y', 19}};
-
+#include "LogSum.h"
+#include "Sampler.h"
+#include "Stats.h"
 
 // UTILS
-// Arrondir utilisé (avant d'écrire les matrices)
-inline float round(float val )
-{
-    if( val < 0 ) return ceil(val - 0.5);
-    return floor(val + 0.5);
+// Exécute work(shard, begin, end) sur threads tranches consécutives [begin, end) de [0, count), une par thread
+template <class Work>
+void run_shards(std::size_t count, unsigned threads, Work work) {
+    std::vector<std::thread> workers;
+    for (unsigned shard = 0; shard < threads; shard++) {
+        workers.emplace_back(work, shard, count * shard / threads, count * (shard + 1) / threads);
+    }
+    for (auto & thread : workers) {
+        thread.join();
+    }
+}
+
+// Nombre de threads de la construction : 0 pour autant que de coeurs
+unsigned thread_count(unsigned threads) {
+    return threads != 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
 }
 
-// Trouver le maximum d'un vecteur entre un point de départ et d'arrivée (ou tout le vecteur par défaut.)
+// Trouver le maximum d'une ligne de size valeurs entre un point de départ et d'arrivée (ou toute la ligne par défaut.)
 // Le i_factor permet d'appliquer une puissance toutes les valeurs = 2 [mod 3]. Utile pour HMM-genseq.
 // Les paramètres par défaut permettent de l'utiliser sans prêter attention à ces particularités, auquel cas on retourne
-// simplement le maximum du vecteur
-std::size_t index_of_max(std::vector<std::optional<float>> & vector, int i_factor=1, std::size_t start=0, std::size_t stop=0);
+// simplement le maximum de la ligne
+std::size_t index_of_max(const float *vector, std::size_t size, int i_factor=1, std::size_t start=0, std::size_t stop=0);
 // Implémentation
-std::size_t index_of_max(std::vector<std::optional<float>> & vector, int i_factor, std::size_t start, std::size_t stop) {
+std::size_t index_of_max(const float *vector, std::size_t size, int i_factor, std::size_t start, std::size_t stop) {
 
     auto value = 0.;
     if (start == stop) {
         start = 0;
-        stop = vector.size();
+        stop = size;
     }
     std::size_t max_index = start;
     for (auto index = start; index < stop; index++) {
         // Raise to the power i_factor (used when searching for the next state)
         if (index % 3 == 2 && i_factor != 1) {
-            if (std::pow(vector[index].value(), i_factor) > value) {
-                value = std::pow(vector[index].value(), i_factor);
+            if (std::pow(vector[index], i_factor) > value) {
+                value = std::pow(vector[index], i_factor);
                 max_index = index;
             }
         }
-        else if (vector[index].value() > value) {
-            value = vector[index].value();
+        else if (vector[index] > value) {
+            value = vector[index];
             max_index = index;
         }
     }
     return max_index;
 }
 
-// Constructeur à partir d'un fichier fasta et d'un alpha (utilisé pour HMM-build)
-HMM::HMM(Fasta fasta, float alpha)
-:sequences_(fasta.parse()),
-marked_columns_(get_marked_columns(sequences_, alpha)),
-N_(std::count(marked_columns_.begin(),marked_columns_.end(), true) + 1 )
+// Constructeur à partir de colonnes marquées (utilisé par build_models)
+HMM::HMM(std::vector<bool> marked_columns)
+:marked_columns_(std::move(marked_columns))
 {
-    T_.emplace_back(9, 1.);
-    // Le premier état n'émet pas de caractère, aussi la ligne est remplie de NaN (ici, optional sans valeur)
-    e_M_.emplace_back(20, std::optional<float>());
-    e_I_.emplace_back(20, 1.);
-    for (auto i = 0; i < N_-2; i++) {
-        T_.emplace_back(9, 1.);
-        e_M_.emplace_back(20, 1.);
-        e_I_.emplace_back(20, 1.);
+    init_build_matrices();
+}
+
+// Plusieurs alpha sur un même fasta (HMM-build) : un modèle par ensemble distinct de colonnes marquées
+std::vector<HMM> HMM::build_models(const Fasta& fasta, const std::vector<float>& alphas, unsigned threads) {
+    threads = thread_count(threads);
+    std::vector<Fasta::View> records;
+    {
+        Stats::Timer timer(Stats::Stage::parse);
+        records.assign(fasta.begin(), fasta.end());
+    }
+    Stats::add(Stats::Counter::sequences, records.size());
+    Stats::Timer timer(Stats::Stage::build);
+    const std::vector<std::uint64_t> gaps = count_gaps(records, threads);
+    // distinct[model_of[a]] est le modèle de alphas[a]
+    std::vector<HMM> distinct;
+    std::vector<std::size_t> model_of;
+    for (float alpha : alphas) {
+        std::vector<bool> marked = get_marked_columns(gaps, records.size(), alpha);
+        auto found = std::find_if(distinct.begin(), distinct.end(), [&marked](const HMM& model) {
+            return model.marked_columns_ == marked;
+        });
+        model_of.push_back(static_cast<std::size_t>(found - distinct.begin()));
+        if (found == distinct.end()) {
+            distinct.push_back(HMM(std::move(marked)));
+        }
+    }
+    std::vector<HMM *> pointers;
+    for (auto & model : distinct) {
+        pointers.push_back(&model);
+    }
+    count_records(records, pointers, threads);
+    std::vector<HMM> models;
+    for (std::size_t index : model_of) {
+        models.push_back(distinct[index]);
     }
+    return models;
+}
+
+// Pseudo-comptes initiaux des matrices (HMM-build)
+void HMM::init_build_matrices() {
+    N_ = std::count(marked_columns_.begin(), marked_columns_.end(), true) + 1;
+    // Pseudo-comptes : 1 partout
+    T_ = Profile::Transitions(N_, 1.);
+    e_M_ = Profile::Emissions(N_, 1.);
+    e_I_ = Profile::Emissions(N_, 1.);
+    // Le premier état n'émet pas de caractère, aussi la ligne est remplie de NaN
+    e_M_.fill_row(0, Profile::Emissions::none);
     // Dernière ligne : 0 pour T
-    T_.emplace_back(9, 0.);
-    e_M_.emplace_back(20, 1.);
-    e_I_.emplace_back(20, 1.);
+    T_.fill_row(N_ - 1, 0.);
     // L'état D0 n'existe pas, aussi les transitions à partir de cet état sont mises à 0.
     T_[0][3] = 0.;
     T_[0][4] = 0.;
@@ -81,63 +134,176 @@ N_(std::count(marked_columns_.begin(),marked_columns_.end(), true) + 1 )
 
 // Constructeur à partir d'un fichier (utilisé par HMM-genseq, HMM-align)
 HMM::HMM(const std::string& model_file) {
-    // parse the model
-    std::ifstream input(model_file);
-    input >> N_;
-    // Initialisation des matrices à 0, première colonne séparément pour gérer e_M[0]
-    T_.emplace_back(9, 0.);
-    e_M_.emplace_back(20, std::optional<float>());
-    e_I_.emplace_back(20, 0.);
-    for (auto i = 0; i < N_-1; i++) {
-        T_.emplace_back(9, 0.);
-        e_M_.emplace_back(20, 0.);
-        e_I_.emplace_back(20, 0.);
-    }
-    std::string test;
-    //T
-    // read line by line
-    for (auto model_line = 0; model_line < N_; model_line++) {
-        // Get the next line
-        input >> test;
-        for (auto model_column = 0; model_column < 9; model_column++) {
-            T_[model_line][model_column] = std::stof(test.substr(6 * model_column, 5));
-        }
-    }
-    //skip NAN line
-    input >> test;
-    //e_M
-    // read line by line
-    for (auto model_line = 1; model_line < N_; model_line++) {
-        // Get the next line
-        input >> test;
-        for (auto model_column = 0; model_column < 20; model_column++) {
-            e_M_[model_line][model_column] = std::stof(test.substr(6 * model_column, 5));
-        }
-    }
-    //e_i
-    // read line by line
-    for (auto model_line = 0; model_line < N_; model_line++) {
-        // Get the next line
-        input >> test;
-        for (auto model_column = 0; model_column < 20; model_column++) {
-            e_I_[model_line][model_column] = std::stof(test.substr(6 * model_column, 5));
+    const auto file = std::make_shared<const MappedFile>(model_file);
+    if (load(file, 0) != file->size()) {
+        throw std::runtime_error("several models in " + model_file + ", expected one");
+    }
+    if (name_.empty()) {
+        name_ = std::filesystem::path(model_file).stem().string();
+    }
+}
+
+// Bibliothèque : les modèles du fichier, lus l'un après l'autre dans la projection
+std::vector<HMM> HMM::load_library(const std::string& library_file) {
+    const auto file = std::make_shared<const MappedFile>(library_file);
+    std::vector<HMM> models;
+    std::size_t offset = TextModel(file->data(), file->data() + file->size()).at_end() ? file->size() : 0;
+    while (offset < file->size()) {
+        models.push_back(HMM());
+        offset = models.back().load(file, offset);
+    }
+    const std::string stem = std::filesystem::path(library_file).stem().string();
+    for (std::size_t k = 0; k < models.size(); k++) {
+        if (models[k].name_.empty()) {
+            models[k].name_ = models.size() == 1 ? stem : stem + ":" + std::to_string(k + 1);
         }
     }
+    return models;
 }
 
-// Calcul des colonnes marquées : Si une colonne a en moyenne moins de alpha '-', elle est marquée.
-std::vector<bool> HMM::get_marked_columns(const std::vector<std::vector<char>>& sequences, float alpha) {
-    std::vector<bool> ret;
-    std::vector<float> acc(sequences[0].size(), 0.0);
-    for (auto seq : sequences) {
-        for (std::size_t i = 0; i < seq.size(); i++){
-            if (seq[i] == '-') {
-                acc[i]++;
+// Chargement d'un modèle : format binaire reconnu à son en-tête, sinon texte
+std::size_t HMM::load(const std::shared_ptr<const MappedFile>& file, std::size_t offset) {
+    Stats::Timer timer(Stats::Stage::load);
+    const char *begin = file->data() + offset;
+    const char *end = file->data() + file->size();
+    if (static_cast<std::size_t>(end - begin) >= sizeof(BinaryModel::magic) &&
+        std::equal(BinaryModel::magic, BinaryModel::magic + sizeof(BinaryModel::magic), begin)) {
+        offset += load_binary_model(file, offset);
+    } else {
+        TextModel reader(begin, end);
+        load_text_model(reader);
+        reader.at_end();
+        offset = static_cast<std::size_t>(reader.position() - file->data());
+    }
+    striped_ = Striped(profile_);
+    striped16_ = Striped16(profile_);
+    ssv_ = Ssv(profile_);
+    return offset;
+}
+
+// Modèle texte : N, puis T, e_M et e_I. La première ligne de e_M (nan) est lue mais pas gardée : l'état M0 n'émet pas.
+void HMM::load_text_model(TextModel& reader) {
+    if (auto name = reader.name()) {
+        name_ = std::move(name.value());
+    }
+    N_ = static_cast<long>(reader.size());
+    T_ = Profile::Transitions(N_, 0.);
+    e_M_ = Profile::Emissions(N_, 0.);
+    e_I_ = Profile::Emissions(N_, 0.);
+    reader.read_matrix(T_);
+    reader.read_matrix(e_M_);
+    reader.read_matrix(e_I_);
+    e_M_.fill_row(0, Profile::Emissions::none);
+    profile_ = Profile(T_, e_M_, e_I_);
+}
+
+// Chargement d'un modèle binaire projeté en mémoire : les probabilités sont recopiées dans les matrices (petites), le
+// profil compilé est lu directement dans le fichier s'il y est
+std::size_t HMM::load_binary_model(const std::shared_ptr<const MappedFile>& file, std::size_t offset) {
+    BinaryModel::Header header{};
+    const std::size_t available = file->size() - offset;
+    if (available < sizeof(header)) {
+        throw std::runtime_error("truncated binary model");
+    }
+    const char *model = file->data() + offset;
+    std::memcpy(&header, model, sizeof(header));
+    if (header.version == 0 || header.version > BinaryModel::version ||
+        header.alphabet_size != Profile::alphabet_size || header.size == 0) {
+        throw std::runtime_error("unsupported binary model");
+    }
+    N_ = static_cast<long>(header.size);
+    const std::size_t transition_bytes = BinaryModel::section_size(header.size * Profile::transitions);
+    const std::size_t emission_bytes = BinaryModel::section_size(header.size * Profile::alphabet_size);
+    // Version 1 : émissions du profil sur 20 colonnes, sans les codes ambigus
+    const std::size_t profile_emission_bytes = header.version == 1 ? emission_bytes :
+            BinaryModel::section_size(header.size * Profile::stride);
+    std::size_t payload = transition_bytes + 2 * emission_bytes;
+    if (header.flags & BinaryModel::with_profile) {
+        payload += transition_bytes + 2 * profile_emission_bytes;
+    }
+    if (available < sizeof(header) + payload ||
+        BinaryModel::checksum(model + sizeof(header), payload) != header.checksum) {
+        throw std::runtime_error("corrupted binary model");
+    }
+    // Les sections sont alignées sur 64 octets, comme le début de la projection et la taille de chaque modèle. Un modèle
+    // binaire qui suit un modèle texte dans une bibliothèque (ou lu d'un tube) peut commencer n'importe où : il est
+    // alors copié dans une zone alignée, que le profil garde en vie à la place du fichier.
+    std::shared_ptr<const void> storage = file;
+    if (reinterpret_cast<std::uintptr_t>(model) % BinaryModel::alignment != 0) {
+        auto copy = std::make_shared<std::vector<char>>(sizeof(header) + payload + BinaryModel::alignment);
+        void *aligned = copy->data();
+        std::size_t space = copy->size();
+        std::align(BinaryModel::alignment, sizeof(header) + payload, aligned, space);
+        std::memcpy(aligned, model, sizeof(header) + payload);
+        model = static_cast<const char *>(aligned);
+        storage = copy;
+    }
+    const char *section = model + sizeof(header);
+    auto next_section = [&section](std::size_t bytes) {
+        const auto *values = reinterpret_cast<const float *>(section);
+        section += bytes;
+        return values;
+    };
+    // Les matrices ont la disposition du fichier (lignes contiguës, NaN sans valeur) : copie directe
+    auto read_matrix = [this](auto& matrix, const float *values) {
+        matrix = std::remove_reference_t<decltype(matrix)>(N_, 0.);
+        std::copy(values, values + matrix.size(), matrix.data());
+    };
+    read_matrix(T_, next_section(transition_bytes));
+    read_matrix(e_M_, next_section(emission_bytes));
+    read_matrix(e_I_, next_section(emission_bytes));
+    // Le profil d'un modèle en version 1 n'a pas de scores pour les codes ambigus : il est recompilé
+    if ((header.flags & BinaryModel::with_profile) && header.version == BinaryModel::version) {
+        const float *transitions = next_section(transition_bytes);
+        const float *match = next_section(profile_emission_bytes);
+        const float *insert = next_section(profile_emission_bytes);
+        profile_ = Profile(header.size, transitions, match, insert, storage);
+    } else {
+        profile_ = Profile(T_, e_M_, e_I_);
+    }
+    return sizeof(header) + payload;
+}
+
+// Comptes des gaps de chaque colonne. Chaque thread compte les gaps de sa tranche de séquences, les comptes sont
+// ensuite additionnés.
+std::vector<std::uint64_t> HMM::count_gaps(const std::vector<Fasta::View>& records, unsigned threads) {
+    std::vector<std::uint64_t> ret;
+    if (records.empty()) {
+        return ret;
+    }
+    // Les séquences alignées ont toutes la longueur de la première
+    std::vector<std::uint8_t> first;
+    records.front().digitize(first);
+    const std::size_t width = first.size();
+    std::vector<std::vector<std::uint64_t>> shard_gaps(threads, std::vector<std::uint64_t>(width, 0));
+    run_shards(records.size(), threads, [&](unsigned shard, std::size_t begin, std::size_t end) {
+        auto & gaps = shard_gaps[shard];
+        std::vector<std::uint8_t> seq;
+        for (std::size_t record = begin; record < end; record++) {
+            seq.clear();
+            records[record].digitize(seq);
+            for (std::size_t i = 0; i < seq.size() && i < width; i++) {
+                if (seq[i] == Alphabet::gap) {
+                    gaps[i]++;
+                }
             }
         }
+    });
+    for (std::size_t i = 0; i < width; i++) {
+        std::uint64_t gaps = 0;
+        for (const auto & shard : shard_gaps) {
+            gaps += shard[i];
+        }
+        ret.push_back(gaps);
     }
-    for (auto count : acc) {
-        if (count / static_cast<float>(sequences.size()) < alpha) {
+    return ret;
+}
+
+// Calcul des colonnes marquées : Si une colonne a en moyenne moins de alpha '-', elle est marquée.
+std::vector<bool> HMM::get_marked_columns(const std::vector<std::uint64_t>& gaps, std::size_t count, float alpha) {
+    std::vector<bool> ret;
+    for (std::uint64_t column_gaps : gaps) {
+        if (static_cast<float>(column_gaps) / static_cast<float>(count) < alpha) {
             ret.push_back(true);
         } else {
             ret.push_back(false);
@@ -147,120 +313,205 @@ std::vector<bool> HMM::get_marked_columns(const std::vector<std::vector<char>>&
 }
 
 // Écriture du modèle comme demandé dans HMM-build
-void HMM::print_model() const {
+void HMM::print_model(std::ostream& stream) const {
+    // 3 chiffres après la virgule (par défaut), tampon vidé dans stream à la fin
+    Output out(stream);
 #ifdef DEBUG
     for (bool mark : marked_columns_) {
-        std::cout << mark << " ";
+        out << static_cast<int>(mark) << " ";
     }
-    std::cout<< std::endl;
+    out << '\n';
 #endif
-    // 3 chiffres après la virgule
-    std::cout << std::setprecision(3) << std::fixed;
-    std::cout << N_ << std::endl;
-    display_matrix(T_);
-    display_matrix(e_M_);
-    display_matrix(e_I_);
+    out << N_ << '\n';
+    display_matrix(out, T_);
+    display_matrix(out, e_M_);
+    display_matrix(out, e_I_);
+}
+
+// Écriture du modèle au format binaire (HMM-build --binary). Les probabilités sont arrondies à 3 décimales comme dans le
+// format texte, pour que les deux formats donnent les mêmes alignements.
+void HMM::print_binary_model(std::ostream& out) const {
+    auto rounded = [](auto matrix) {
+        char text[32];
+        for (std::size_t i = 0; i < matrix.size(); i++) {
+            float & element = matrix.data()[i];
+            if (not std::isnan(element)) {
+                std::snprintf(text, sizeof(text), "%.3f", element);
+                element = std::strtof(text, nullptr);
+            }
+        }
+        return matrix;
+    };
+    const auto T = rounded(T_);
+    const auto e_M = rounded(e_M_);
+    const auto e_I = rounded(e_I_);
+    const Profile profile(T, e_M, e_I);
+    const auto size = static_cast<std::size_t>(N_);
+
+    std::string payload;
+    auto write_section = [&payload](const float *values, std::size_t count) {
+        std::string section(BinaryModel::section_size(count), '\0');
+        std::memcpy(section.data(), values, count * sizeof(float));
+        payload += section;
+    };
+    write_section(T.data(), T.size());
+    write_section(e_M.data(), e_M.size());
+    write_section(e_I.data(), e_I.size());
+    write_section(profile.transition(0), size * Profile::transitions);
+    write_section(profile.match(0), size * Profile::stride);
+    write_section(profile.insert(0), size * Profile::stride);
+
+    BinaryModel::Header header{};
+    std::copy(std::begin(BinaryModel::magic), std::end(BinaryModel::magic), header.magic);
+    header.version = BinaryModel::version;
+    header.alphabet_size = Profile::alphabet_size;
+    header.size = size;
+    header.flags = BinaryModel::with_profile;
+    header.checksum = BinaryModel::checksum(payload.data(), payload.size());
+    Stats::Timer timer(Stats::Stage::output);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+    out.flush();
 }
 
 // Écriture de matrice, ligne apr ligne, si la valeur existe
-void HMM::display_matrix(std::vector<std::vector<std::optional<float>>> matrix) {
-    for (auto & line : matrix) {
-        for (std::size_t j = 0; j < line.size(); j++) {
-            if (line[j].has_value()) {
-                std::cout << line[j].value();
+template <std::size_t Columns>
+void HMM::display_matrix(Output& out, const Matrix<Columns>& matrix) {
+    for (std::size_t i = 0; i < matrix.rows(); i++) {
+        for (std::size_t j = 0; j < Columns; j++) {
+            if (matrix.has_value(i, j)) {
+                out << matrix[i][j];
             } else {
-                std::cout << "nan";
+                out << "nan";
             }
-            if (j != line.size() - 1) {
-                std::cout << ',';
+            if (j != Columns - 1) {
+                out << ',';
             } else {
-                std::cout << std::endl;
+                out << '\n';
             }
         }
     }
 }
 
-// Algorithme de construction de modèle (HMM-build)
-void HMM::build_model() {
-    // Pour chaque séquence Ak de A
-    std::vector<HMMState> Pi_k;
-    std::size_t l_count; // l
-    int model_column; // u
-    // Pour chaque séquence de A_k
-    for (auto & A_k : sequences_) {
-        // Début au rang 0
-        model_column = 0;
-        // Détermination de Pi_k
-        Pi_k.clear();
-        Pi_k = build_Pi_k(A_k);
-        // Fin détermination de Pi_k
-
-        // Mettre à jour les matrices à partir de Pi_k
-        l_count = 0;
-#ifdef DEBUG
-        for (auto& state : Pi_k) {
-            std::cout << static_cast<int>(state) << " ";
+// Comptes de construction de plusieurs modèles (HMM-build). Les séquences sont réparties en tranches consécutives entre
+// les threads, qui comptent chacun dans leurs propres tables d'entiers (une par modèle) ; les tables sont ensuite
+// additionnées aux pseudo-comptes initiaux des matrices.
+void HMM::count_records(const std::vector<Fasta::View>& records, const std::vector<HMM *>& models, unsigned threads) {
+    // shard_counts[shard][model]
+    std::vector<std::vector<BuildCounts>> shard_counts(threads, std::vector<BuildCounts>(models.size()));
+    run_shards(records.size(), threads, [&](unsigned shard, std::size_t begin, std::size_t end) {
+        auto & counts = shard_counts[shard];
+        for (std::size_t model = 0; model < models.size(); model++) {
+            const auto size = static_cast<std::size_t>(models[model]->N_);
+            counts[model].T.assign(size * 9, 0);
+            counts[model].e_M.assign(size * Alphabet::size, 0);
+            counts[model].e_I.assign(size * Alphabet::size, 0);
         }
-        std::cout << std::endl;
-#endif
-        // Déterminer la première position l0 non None
-        while (l_count < Pi_k.size() && Pi_k[l_count] == HMMState::None) {
-            l_count++;
-        }
-
-        // Si le premier état l0 non None est I
-        if (Pi_k[l_count] == HMMState::I) {
-            // Ajouter 1 à la position correspondant à l'acide aminé A_k[l0] dans e_I[0]
-            e_I_[model_column][alphabet[A_k[l_count]]] =
-                    e_I_[model_column][alphabet[A_k[l_count]]].value() + 1;
-        }
-        // Mettre à jour T0 en considérant que l'état précédent est M
-        T_[model_column][static_cast<int>(Pi_k[l_count])] =
-                T_[model_column][static_cast<int>(Pi_k[l_count])].value() + 1;
-        // Ensuite, pour chaque colonne l >= l0 de A_k
-        while (l_count < A_k.size()) {
-            if (marked_columns_[l_count]) {
-                model_column++;
+        // Séquence courante, lue et digitalisée dans le fichier une fois pour tous les modèles (tampon réutilisé d'une
+        // séquence à l'autre)
+        std::vector<std::uint8_t> A_k;
+        for (std::size_t record = begin; record < end; record++) {
+            A_k.clear();
+            records[record].digitize(A_k);
+            for (std::size_t model = 0; model < models.size(); model++) {
+                models[model]->count_sequence(A_k, counts[model]);
             }
-            // Si Pi_k[l] est un état M
-            // Et Ak_l différent de '-'
-            if (Pi_k[l_count] == HMMState::M && A_k[l_count] != '-' && model_column != 0) {
-                // Ajouter 1 à la position correspondant à l'acide aminé A_k[l] dans e_M[u]
-                // Skip caractère "X"
-                if (A_k[l_count] != 'X') {
-                    e_M_[model_column][alphabet[A_k[l_count]]] =
-                            e_M_[model_column][alphabet[A_k[l_count]]].value() + 1;
+        }
+    });
+    // Réduction : les comptes sont exacts, l'ordre des tranches n'a pas d'importance
+    for (std::size_t model = 0; model < models.size(); model++) {
+        HMM & hmm = *models[model];
+        const auto size = static_cast<std::size_t>(hmm.N_);
+        for (std::size_t k = 0; k < size; k++) {
+            for (std::size_t t = 0; t < 9; t++) {
+                std::uint64_t count = 0;
+                for (const auto & counts : shard_counts) {
+                    count += counts[model].T[k * 9 + t];
                 }
+                hmm.T_[k][t] += static_cast<float>(count);
             }
-            // Respectivement I
-            else if (Pi_k[l_count] == HMMState::I && A_k[l_count] != '-') {
-                // Et Ak_l différent de '-'
-                // Ajouter 1 à la position correspondant à l'acide aminé A_k[l] dans e_I[u]
-                // Skip le caractère "X"
-                if (A_k[l_count] != 'X') {
-                    e_I_[model_column][alphabet[A_k[l_count]]] =
-                            e_I_[model_column][alphabet[A_k[l_count]]].value() + 1;
+            for (std::size_t a = 0; a < Alphabet::size; a++) {
+                std::uint64_t match = 0;
+                std::uint64_t insert = 0;
+                for (const auto & counts : shard_counts) {
+                    match += counts[model].e_M[k * Alphabet::size + a];
+                    insert += counts[model].e_I[k * Alphabet::size + a];
+                }
+                // e_M[0] n'a pas de valeur (et n'est jamais compté)
+                if (k != 0) {
+                    hmm.e_M_[k][a] += static_cast<float>(match);
                 }
+                hmm.e_I_[k][a] += static_cast<float>(insert);
             }
-            std::size_t i = l_count + 1;
-            // Inutile de checker la size, la séquence est toujours finie par M.
-            // On cherche le prochain état valide (non None)
-            while (Pi_k[i] == HMMState::None) {
-                i++;
+        }
+        hmm.normalize_matrixes();
+    }
+}
+
+// Comptes d'une séquence alignée (HMM-build)
+void HMM::count_sequence(const std::vector<std::uint8_t>& A_k, BuildCounts& counts) const {
+    // Début au rang 0
+    std::size_t model_column = 0; // u
+    // Détermination de Pi_k
+    const std::vector<HMMState> Pi_k = build_Pi_k(A_k);
+    // Mettre à jour les comptes à partir de Pi_k
+    std::size_t l_count = 0; // l
+#ifdef DEBUG
+    for (auto& state : Pi_k) {
+        std::cout << static_cast<int>(state) << " ";
+    }
+    std::cout << std::endl;
+#endif
+    // Déterminer la première position l0 non None
+    while (l_count < Pi_k.size() && Pi_k[l_count] == HMMState::None) {
+        l_count++;
+    }
+
+    // Si le premier état l0 non None est I
+    if (Pi_k[l_count] == HMMState::I) {
+        // Ajouter 1 à la position correspondant à l'acide aminé A_k[l0] dans e_I[0]
+        // Les codes ambigus (X, B, Z...) ne sont pas comptés
+        if (A_k[l_count] < Alphabet::size) {
+            counts.e_I[model_column * Alphabet::size + A_k[l_count]]++;
+        }
+    }
+    // Mettre à jour T0 en considérant que l'état précédent est M
+    counts.T[model_column * 9 + static_cast<int>(Pi_k[l_count])]++;
+    // Ensuite, pour chaque colonne l >= l0 de A_k
+    while (l_count < A_k.size()) {
+        if (marked_columns_[l_count]) {
+            model_column++;
+        }
+        // Si Pi_k[l] est un état M
+        // Et Ak_l différent de '-'
+        if (Pi_k[l_count] == HMMState::M && A_k[l_count] != Alphabet::gap && model_column != 0) {
+            // Ajouter 1 à la position correspondant à l'acide aminé A_k[l] dans e_M[u]
+            // Skip les codes ambigus ("X", "B"...)
+            if (A_k[l_count] < Alphabet::size) {
+                counts.e_M[model_column * Alphabet::size + A_k[l_count]]++;
             }
-            // Mettre à jour T_u s'il y a un prochain état valable
-            if (i < Pi_k.size() && Pi_k[l_count] != HMMState::None) {
-                T_[model_column][static_cast<int>(Pi_k[l_count]) * 3 + static_cast<int>(Pi_k[i])] =
-                        T_[model_column][static_cast<int>(Pi_k[l_count]) * 3 + static_cast<int>(Pi_k[i])].value() + 1;
+        }
+        // Respectivement I
+        else if (Pi_k[l_count] == HMMState::I && A_k[l_count] != Alphabet::gap) {
+            // Et Ak_l différent de '-'
+            // Ajouter 1 à la position correspondant à l'acide aminé A_k[l] dans e_I[u]
+            // Skip les codes ambigus ("X", "B"...)
+            if (A_k[l_count] < Alphabet::size) {
+                counts.e_I[model_column * Alphabet::size + A_k[l_count]]++;
             }
-            l_count++;
         }
+        std::size_t i = l_count + 1;
+        // Inutile de checker la size, la séquence est toujours finie par M.
+        // On cherche le prochain état valide (non None)
+        while (Pi_k[i] == HMMState::None) {
+            i++;
+        }
+        // Mettre à jour T_u s'il y a un prochain état valable
+        if (i < Pi_k.size() && Pi_k[l_count] != HMMState::None) {
+            counts.T[model_column * 9 + static_cast<int>(Pi_k[l_count]) * 3 + static_cast<int>(Pi_k[i])]++;
+        }
+        l_count++;
     }
-    normalize_matrixes();
-    // Ne donne pas de meilleurs résultats, mais pour la forme
-    round_matrix(T_);
-    round_matrix(e_M_);
-    round_matrix(e_I_);
 }
 
 // Normalisation pour HMM-build
@@ -275,13 +526,12 @@ void HMM::normalize_matrixes() {
             sum_t = 0;
             // Calcul de la somme par état (M, D, I)
             for (auto transition = 0; transition < 3; transition++) {
-                sum_t += T_[i][3 * state + transition].value();
+                sum_t += T_[i][3 * state + transition];
             }
             // Normalisation par état (M, D, I)
             if (sum_t != 0) {
                 for (auto transition = 0; transition < 3; transition++) {
-                    T_[i][3 * state + transition].value() =
-                            T_[i][3 * state + transition].value() / sum_t;
+                    T_[i][3 * state + transition] /= sum_t;
                 }
             }
         }
@@ -291,12 +541,12 @@ void HMM::normalize_matrixes() {
         sum_m = 0;
         // Somme
         for (auto column = 0; column < 20; column++) {
-            sum_m += e_M_[line][column].value();
+            sum_m += e_M_[line][column];
 
         }
         // Normalisation
         for (auto column = 0; column < 20; column++) {
-            e_M_[line][column]  = e_M_[line][column].value() / sum_m;
+            e_M_[line][column] /= sum_m;
 
         }
     }
@@ -305,26 +555,26 @@ void HMM::normalize_matrixes() {
         sum_i = 0;
         // Somme
         for (auto column = 0; column < 20; column++) {
-            sum_i += e_I_[line][column].value();
+            sum_i += e_I_[line][column];
 
         }
         // Normalisation
         for (auto column = 0; column < 20; column++) {
-            e_I_[line][column] = e_I_[line][column].value() / sum_i;
+            e_I_[line][column] /= sum_i;
 
         }
     }
 }
 
 // Construction de Pi_k à partir des séquences (HMM-build)
-std::vector<HMM::HMMState> HMM::build_Pi_k(const std::vector<char>& sequence) {
+std::vector<HMM::HMMState> HMM::build_Pi_k(const std::vector<std::uint8_t>& sequence) const {
     std::vector<HMMState> ret;
     auto column_count = 0;
     for (auto & l : sequence) {
         // Si la colonne est marquée
         if (marked_columns_[column_count]) {
             // Si c'est un '-', alors c'est un état D
-            if (l == '-') {
+            if (l == Alphabet::gap) {
                 ret.emplace_back(HMMState::D);
             }
             // Sinon c'est un état M
@@ -335,7 +585,7 @@ std::vector<HMM::HMMState> HMM::build_Pi_k(const std::vector<char>& sequence) {
         // Si la colonne l n'est pas marquée
         else {
             // Si c'est un '-', alors elle n'a pas d'état
-            if (l == '-') {
+            if (l == Alphabet::gap) {
                 ret.emplace_back(HMMState::None);
             }
             // Sinon c'est un état I
@@ -352,10 +602,10 @@ std::vector<HMM::HMMState> HMM::build_Pi_k(const std::vector<char>& sequence) {
 
 
 // HMM-genseq
-void HMM::build_print_genseq() {
-    // Les valeurs à écrire en sortie
-    std::string sequence;
-    std::string states_sequence;
+HMM::Alignment HMM::most_probable_sequence() const {
+    Alignment alignment;
+    std::string & sequence = alignment.sequence;
+    std::string & states_sequence = alignment.states;
     // On part toujours de l'état M
     HMMState current_state = HMMState::M;
     // Compteurs pour éviter les boucles infinies sur I
@@ -366,10 +616,14 @@ void HMM::build_print_genseq() {
     // Pour chaque rang du modèle
     while(chain_index < N_) {
         // Calcul du prochain état : on cherche la probabilité la plus haute de l'ancien état
-        current_state = static_cast<HMMState>(index_of_max(T_[chain_index],
-                                                           k_i,
-                                                           static_cast<int>(current_state) * 3,
-                                                           static_cast<int>(current_state) * 3 + 3) % 3);
+        const auto next_state = static_cast<HMMState>(index_of_max(T_[chain_index],
+                                                                   Profile::transitions,
+                                                                   k_i,
+                                                                   static_cast<int>(current_state) * 3,
+                                                                   static_cast<int>(current_state) * 3 + 3) % 3);
+        alignment.score += std::log(T_[chain_index][static_cast<int>(current_state) * 3 +
+                                                    static_cast<int>(next_state)]);
+        current_state = next_state;
         // Si l'état est M ou D, incrémenter le rang
         if (current_state == HMMState::M || current_state == HMMState::D) {
             chain_index++;
@@ -408,189 +662,812 @@ void HMM::build_print_genseq() {
             // modèle
             if (current_state == HMMState::M) {
                 sequence.push_back(most_probable_char(e_M_[chain_index]));
+                alignment.score += std::log(e_M_[chain_index][Alphabet::digitize(sequence.back())]);
             } else if (current_state == HMMState::I) { // Similaire pour I
                 sequence.push_back(most_probable_char(e_I_[chain_index]));
+                alignment.score += std::log(e_I_[chain_index][Alphabet::digitize(sequence.back())]);
             } else { // C'est un état D (deletion), on ajoute un '-'
                 sequence.push_back('-');
             }
         }
     }
-    // Écriture des résultats sur la sortie standard.
-    std::cout << sequence << std::endl;
-    std::cout << states_sequence << std::endl;
+    Stats::add(Stats::Counter::sequences, 1);
+    set_coordinates(alignment);
+    return alignment;
+}
+
+// HMM-genseq --sample
+void HMM::sample_genseq(std::size_t count, std::uint64_t seed, unsigned threads, std::ostream& out) const {
+    Sampler(T_, e_M_, e_I_).run(count, seed, threads, name_, out);
 }
 
 // Recherche du caractère le plus probable
-char HMM::most_probable_char(std::vector<std::optional<float>> &vector) {
+char HMM::most_probable_char(const float *line) {
     // Index
-    auto max_index = index_of_max(vector);
-    // Reverse find
-    return find_alphabet_value_of(max_index);
+    auto max_index = index_of_max(line, Alphabet::size);
+    return Alphabet::residue(max_index);
 }
 
-// Arrondi
-void HMM::round_matrix(std::vector<std::vector<std::optional<float>>> matrix) {
-    for (auto & line : matrix) {
-        for (auto & element : line) {
-            if (element.has_value()) {
-                element = round((element.value() * 1000) / 1000);
+// Alignement d'une séquence quelconque sur le modèle, résultat renvoyé sous forme de texte : le score (options score
+// et posterior), puis la séquence alignée et la séquence d'états (sauf option score)
+std::string HMM::align(const std::vector<char>& sequence, const AlignOptions& options) const {
+    Output out;
+    // Hors du mode global : une ligne de score et de coordonnées par domaine, suivie de son alignement
+    if (options.mode != Mode::global && not options.score) {
+        for (const auto & hit : align_hits(sequence, options)) {
+            out << hit.score << '\t' << hit.sequence_begin << '\t' << hit.sequence_end << '\t' << hit.model_begin
+                << '\t' << hit.model_end << '\n';
+            out << hit.sequence << '\n';
+            out << hit.states << '\n';
+        }
+        return out.str();
+    }
+    const Alignment alignment = align_sequence(sequence, options);
+    if (options.score || options.posterior) {
+        out << alignment.score << '\n';
+    }
+    if (not options.score) {
+        out << alignment.sequence << '\n';
+        out << alignment.states << '\n';
+    }
+    return out.str();
+}
+
+// Alignement d'une séquence quelconque sur le modèle
+HMM::Alignment HMM::align_sequence(const std::vector<char>& sequence, const AlignOptions& options) const {
+    if (options.mode != Mode::global) {
+        const std::vector<Alignment> hits = align_hits(sequence, options);
+        if (hits.empty()) {
+            Alignment alignment;
+            alignment.score = -1 * std::numeric_limits<float>::infinity();
+            return alignment;
+        }
+        return *std::max_element(hits.begin(), hits.end(), [](const Alignment& a, const Alignment& b) {
+            return a.score < b.score;
+        });
+    }
+    Alignment alignment;
+    // Digitalisation de la séquence, une seule fois. Les gaps ne sont pas des acides aminés : ils sont retirés, de la
+    // séquence digitalisée comme du texte utilisé pour écrire la séquence alignée.
+    std::vector<std::uint8_t> residues;
+    std::vector<char> text;
+    residues.reserve(sequence.size());
+    text.reserve(sequence.size());
+    for (auto residue : sequence) {
+        auto code = Alphabet::digitize(residue);
+        if (code != Alphabet::gap) {
+            residues.push_back(code);
+            text.push_back(residue);
+        }
+    }
+    // Option --band : le score, puis l'étape retour, sont calculés dans la bande, sauf si le meilleur chemin de la
+    // bande en touche le bord ; dans ce cas, la matrice est calculée en entier
+    std::optional<ViterbiBand> band;
+    const bool banded = options.band != 0 && not options.posterior && not residues.empty();
+    if (banded) {
+        band = ViterbiBand{options.band, static_cast<std::size_t>(N_), residues.size()};
+        bool touched = false;
+        const float band_score = banded_score(residues, band.value(), touched);
+        if (touched) {
+            band.reset();
+        } else if (options.score) {
+            alignment.score = band_score;
+            return alignment;
+        }
+    }
+    // Option --score : le score est calculé sans matrice, par le moteur vectorisé s'il est disponible (viterbi)
+    // (la bande, si elle vient d'être tentée, n'est pas recalculée)
+    if (options.score) {
+        alignment.score = banded ? full_score(residues, options.integer) : score(residues, options);
+        return alignment;
+    }
+    // Option --posterior : score Forward, puis alignement d'exactitude maximale
+    if (options.posterior) {
+        std::tie(alignment.score, alignment.sequence, alignment.states) = posterior_traceback(text, residues);
+        set_coordinates(alignment);
+        return alignment;
+    }
+    // Étape retour : 2 bits par case de la matrice. Au delà de la mémoire autorisée, étape retour par blocs de
+    // racine de L colonnes, sinon un seul bloc couvrant toute la séquence.
+    const auto words = static_cast<std::size_t>((3 * N_ + 1 + 31) / 32);
+    std::size_t block = text.size();
+    if (options.max_memory != 0 && words * sizeof(std::uint64_t) * text.size() > options.max_memory) {
+        block = static_cast<std::size_t>(std::ceil(std::sqrt(static_cast<double>(text.size()))));
+    }
+    std::tie(alignment.score, alignment.sequence, alignment.states) = viterbi_traceback(
+            text, residues, block, band.value_or(ViterbiBand{static_cast<std::size_t>(N_), static_cast<std::size_t>(N_),
+                                                             text.size()}));
+    set_coordinates(alignment);
+    return alignment;
+}
+
+void HMM::check_options(const AlignOptions& options) {
+    if (options.posterior && options.mode != Mode::global) {
+        throw std::invalid_argument("posterior decoding is only available in global mode");
+    }
+}
+
+// Domaines : hors du mode global, ceux du meilleur chemin de local_viterbi
+std::vector<HMM::Alignment> HMM::align_hits(const std::vector<char>& sequence, const AlignOptions& options) const {
+    if (options.mode == Mode::global) {
+        return {align_sequence(sequence, options)};
+    }
+    check_options(options);
+    // Digitalisation, gaps retirés, comme pour l'alignement global
+    std::vector<std::uint8_t> residues;
+    std::vector<char> text;
+    for (auto residue : sequence) {
+        auto code = Alphabet::digitize(residue);
+        if (code != Alphabet::gap) {
+            residues.push_back(code);
+            text.push_back(residue);
+        }
+    }
+    if (options.score) {
+        Alignment alignment;
+        alignment.score = local_viterbi(text, residues, options, nullptr);
+        return {alignment};
+    }
+    std::vector<Alignment> hits;
+    local_viterbi(text, residues, options, &hits);
+    return hits;
+}
+
+// Coordonnées : chaque état M ou I émet l'acide aminé suivant, chaque état M ou D passe au rang suivant
+void HMM::set_coordinates(Alignment& alignment) {
+    std::size_t j = 0;
+    std::size_t k = 0;
+    bool found = false;
+    for (char state : alignment.states) {
+        if (state != 'I') {
+            k++;
+        }
+        if (state == 'M') {
+            if (not found) {
+                alignment.sequence_begin = j;
+                alignment.model_begin = k;
+                found = true;
             }
+            alignment.sequence_end = j + 1;
+            alignment.model_end = k + 1;
+        }
+        if (state != 'D') {
+            j++;
         }
     }
 }
 
-// Setter
-void HMM::set_sequences(std::vector<std::vector<char>> sequences) {
-    sequences_ = std::move(sequences);
-}
-
-// HMM-align
-void HMM::viterbi(bool score) {
-    // Matrice de score
-    std::vector<std::vector<std::optional<float>>> V;
-    // Matrice retour
-    std::vector<std::vector<std::pair<int, int>>> B;
-
-    // Modificateurs temporaires sur i et j
-    int i_mod;
-    int j_mod;
-    // Valeurs temporaires pour calculer le maximum et la prochaine valeur de V[i][j], et l'étape retour
-    float tmp;
-    float v_i_j_value;
-    float max_value;
-    std::pair<int, int> max_coordinates;
-    // epsilon
-    const float epsilon = 1e-20;
-
-    // Initialisation des matrices sans valeur, sauf la première colonne qui vaut -inf
-    for (auto line = 0; line < 3 * N_ + 1; line++) {
-        V.emplace_back(sequences_.back().size() + 1, std::optional<float>());
-        V.back()[0] = -1 * std::numeric_limits<float>::infinity();
-        B.emplace_back(sequences_.back().size() + 1, std::pair<int, int>(-1, -1));
-    }
-    // Première et seconde ligne à -inf
-    for (std::size_t column = 0; column < V.back().size(); column ++) {
-        V[0][column] = -1 * std::numeric_limits<float>::infinity();
-        V[1][column] = -1 * std::numeric_limits<float>::infinity();
-    }
-    // Sauf V[0][0] = 0
-    V[0][0] = 0;
-    for(auto i = 2; i < 3 * N_ + 1; i++) {
-        for (std::size_t j = 1; j < sequences_.back().size() + 1; j++) {
-            // Calcul du prochain état : en fonction de i % 3 : 0 -> M; 1 -> D; 2 -> I (else none pour la forme)
-            // Pour chaque état, calcul du modificateur d'index sur i et j ainsi que de la valeur v_i_j propre à chaque
-            // état. L'usage des modificateurs permet d'avoir une formule unique dans le calcul du max, car les valeurs
-            // à tester sont les mêmes à un facteur constant prêt dans les 3 cas.
-            if (i % 3 == 0) /* État M */ {
-                i_mod = 1;
-                j_mod = 1;
-                // Calcul de la "constante" en fonction de e_M
-                if (i < 3 * N_) {
-                    v_i_j_value = logf(e_M_[i / 3][alphabet[sequences_.back()[j - 1]]].value() + epsilon);
-                } else {
-                    v_i_j_value = 0;
-                    j_mod = 0;
-                }
+// Score seul, sans matrice : Forward, ou viterbi dans la bande, ou viterbi par le moteur vectorisé s'il est disponible
+// (sur entiers 16 bits avec l'option integer, tant qu'ils ne saturent pas)
+float HMM::score(const std::vector<std::uint8_t>& residues, const AlignOptions& options) const {
+    if (options.mode != Mode::global) {
+        check_options(options);
+        return local_viterbi({}, residues, options, nullptr);
+    }
+    if (options.posterior) {
+        return forward_score(residues);
+    }
+    if (options.band != 0 && not residues.empty()) {
+        bool touched = false;
+        const float banded = banded_score(residues, ViterbiBand{options.band, static_cast<std::size_t>(N_),
+                                                                residues.size()}, touched);
+        if (not touched) {
+            return banded;
+        }
+    }
+    return full_score(residues, options.integer);
+}
+
+float HMM::full_score(const std::vector<std::uint8_t>& residues, bool integer) const {
+    if (integer && striped16_.available()) {
+        Stats::Timer timer(Stats::Stage::fill);
+        Stats::add(Stats::Counter::cells, static_cast<std::size_t>(N_) * residues.size());
+        if (const std::optional<float> score = striped16_.score(residues)) {
+            return *score;
+        }
+    }
+    if (not striped_.available()) {
+        return viterbi_score(residues);
+    }
+    Stats::Timer timer(Stats::Stage::fill);
+    Stats::add(Stats::Counter::cells, static_cast<std::size_t>(N_) * residues.size());
+    return striped_.score(residues);
+}
+
+float HMM::prefilter_score(const std::vector<std::uint8_t>& residues) const {
+    Stats::Timer timer(Stats::Stage::prefilter);
+    Stats::add(Stats::Counter::cells, static_cast<std::size_t>(N_) * residues.size());
+    return ssv_.score(residues);
+}
+
+std::size_t HMM::size() const {
+    return static_cast<std::size_t>(N_);
+}
+
+const std::string& HMM::name() const {
+    return name_;
+}
 
-            } else if (i % 3 == 1) /* État D */ {
-                i_mod = 2;
-                j_mod = 0;
-                // Réinitialisation des compteurs
-                // La "constante" vaut 0, car c'est un état D
-                v_i_j_value = 0;
-
-            } else if (i % 3 == 2) /* État I */ {
-                i_mod = 0;
-                j_mod = 1;
-                // Calcul de la "constante" en fonction de e_I
-                v_i_j_value = logf(e_I_[i / 3][alphabet[sequences_.back()[j - 1]]].value() + epsilon);
+// Table des lignes de la matrice de viterbi V, de taille (3N+1) x (L+1)
+std::vector<HMM::ViterbiRow> HMM::viterbi_rows() const {
+    std::vector<ViterbiRow> rows(3 * N_ + 1, ViterbiRow{0, 0, nullptr, {0, 0, 0}});
+    for (auto i = 2; i < 3 * N_ + 1; i++) {
+        auto & row = rows[i];
+        // Calcul du prochain état : en fonction de i % 3 : 0 -> M; 1 -> D; 2 -> I
+        // Pour chaque état, calcul du modificateur d'index sur i et j ainsi que de la ligne d'émission propre à chaque
+        // état. L'usage des modificateurs permet d'avoir une formule unique dans le calcul du max, car les valeurs
+        // à tester sont les mêmes à un facteur constant prêt dans les 3 cas : V[i - i_mod - tmp_mod][j - j_mod].
+        if (i % 3 == 0) /* État M */ {
+            row = {1, 1, i < 3 * N_ ? profile_.match(i / 3) : nullptr, {}};
+            // L'état final n'émet rien et reste dans la même colonne
+            if (i == 3 * N_) {
+                row.j_mod = 0;
             }
-            // Calculer les 3 valeurs si elles existent (check index)
-            // Réinitialisation de la recherche de max
-            max_value = -1 * std::numeric_limits<float>::infinity();
-            max_coordinates = {i - i_mod - 2, j - j_mod};
-            // Calcul du maximum des 3 valeurs recherchées. On utilise tmp mod pour itérer sur les 3 valeurs
-            for (int tmp_mod = 0; tmp_mod < 3; tmp_mod++) {
-                // Calcul de V[][] + log(T[][])
-                tmp = V[i - i_mod - tmp_mod][j - j_mod].value() +
-                        logf(T_[(i - i_mod - tmp_mod) / 3][(3 * (2 - tmp_mod)) + (i % 3)].value());
-                // Comparaison avec le maximum actuel
-                if (tmp >= max_value) {
-                    max_value = tmp;
-                    max_coordinates = {i - i_mod - tmp_mod, j - j_mod};
-                }
+        } else if (i % 3 == 1) /* État D */ {
+            row = {2, 0, nullptr, {}};
+        } else /* État I */ {
+            row = {0, 1, profile_.insert(i / 3), {}};
+        }
+        for (int tmp_mod = 0; tmp_mod < 3; tmp_mod++) {
+            row.log_transition[tmp_mod] = profile_.transition((i - row.i_mod - tmp_mod) / 3)[(3 * (2 - tmp_mod)) + (i % 3)];
+        }
+    }
+    return rows;
+}
+
+// Colonne j de la matrice de viterbi. Les lignes sont parcourues dans l'ordre : les états D et l'état final, qui restent
+// dans la même colonne, ne dépendent que de lignes déjà calculées.
+void HMM::viterbi_column(const std::vector<ViterbiRow>& rows, const float *previous, float *current,
+                         std::uint8_t residue, std::uint64_t *choices, std::size_t first, std::size_t last,
+                         float start, float entry) {
+    current[0] = start;
+    current[1] = -1 * std::numeric_limits<float>::infinity();
+    // Mot de 32 choix en cours de construction (les lignes 0 et 1, et celles hors de la bande, n'ont pas de choix : 0)
+    std::uint64_t word = 0;
+    for (std::size_t i = first; i <= last; i++) {
+        const auto & row = rows[i];
+        const float *column = row.j_mod == 1 ? previous : current;
+        // Calcul du maximum des 3 valeurs V[][] + log(T[][]). En cas d'égalité, la dernière l'emporte.
+        float max_value = -1 * std::numeric_limits<float>::infinity();
+        std::uint64_t choice = 2;
+        for (int tmp_mod = 0; tmp_mod < 3; tmp_mod++) {
+            float tmp = column[i - row.i_mod - tmp_mod] + row.log_transition[tmp_mod];
+            if (tmp >= max_value) {
+                max_value = tmp;
+                choice = tmp_mod;
+            }
+        }
+        // Entrée directe dans un état M (mode local)
+        if (i % 3 == 0 && row.emission != nullptr && entry > max_value) {
+            max_value = entry;
+            choice = 3;
+        }
+        // Ajouter le maximum au terme d'émission et sauvegarder
+        current[i] = (row.emission != nullptr ? row.emission[residue] : 0) + max_value;
+        word |= choice << (2 * (i % 32));
+        if (i % 32 == 31) {
+            if (choices != nullptr) {
+                choices[i / 32] = word;
             }
-            // Ajouter le maximum au terme d'émission et sauvegarder
-            V[i][j] = v_i_j_value + max_value;
-            // Étape retour : on retient les coordonnées de la case maximale utilisée pour remplir V[i][j]
-            B[i][j] = max_coordinates;
+            word = 0;
         }
     }
-    // Option --score : display le score et quitter
-    if (score) {
-        std::cout << std::setprecision(3) << std::fixed << V.back().back().value() << std::endl;
-        return;
+    if (choices != nullptr && last % 32 != 31) {
+        choices[last / 32] = word;
     }
-#ifdef DEBUG
-    // Debug : print V
-    display_matrix(V);
-    // Debug : print B
-    display_matrix(B);
-#endif
-    // Étape retour : construction des états et de la séquence alignée : on part de la case en bas à droite de V
-    std::pair<int, int> current_cell = B.back().back();
-    std::string sequence{};
-    std::string states_sequence{};
-    // Tant que nous n'avons pas 0,0
-    while (current_cell != std::pair<int, int>(0, 0)) {
-        // Calcul de l'état actuel : la ligne sur laquelle on se trouve % 3 (0=M, 1=D, 2=I)
-        // On ajoute l'état actuel au début de la liste d'état (car on reconstruit à l'envers la liste d'états)
-        // On ajoute le caractère à la position contenue dans le 2è élément de la paire - 1 à la séquence d'acide aminés
-        switch (static_cast<HMMState>(current_cell.first % 3)) {
+}
+
+// Parcours d'un bloc de l'étape retour, à partir de la case (cell_i, cell_j), tant qu'elle est dans le bloc
+void HMM::trace_block(const std::vector<ViterbiRow>& rows, const std::vector<char>& sequence,
+                      const std::uint64_t *choices, std::size_t words, std::size_t start, std::size_t& cell_i,
+                      std::size_t& cell_j, std::string& aligned_sequence, std::string& states_sequence) {
+    while (cell_j > start) {
+        const auto & row = rows[cell_i];
+        const std::uint64_t word = choices[(cell_j - start - 1) * words + cell_i / 32];
+        const std::size_t choice = (word >> (2 * (cell_i % 32))) & 3;
+        // Case précédente : V[i - i_mod - tmp_mod][j - j_mod]
+        cell_i = cell_i - row.i_mod - choice;
+        cell_j = cell_j - row.j_mod;
+        // Arrivée en V[0][0]
+        if (cell_j == 0) {
+            break;
+        }
+        // État de la case : la ligne % 3 (0=M, 1=D, 2=I). Le caractère émis par M et I est celui de la colonne - 1.
+        switch (static_cast<HMMState>(cell_i % 3)) {
             case HMMState::M:
-                states_sequence.insert(0, 1,'M');
-                sequence.insert(0, 1, sequences_.back()[current_cell.second - 1]);
+                states_sequence.push_back('M');
+                aligned_sequence.push_back(sequence[cell_j - 1]);
                 break;
             case HMMState::D:
-                states_sequence.insert(0, 1,'D');
-                sequence.insert(0, 1, '-');
+                states_sequence.push_back('D');
+                aligned_sequence.push_back('-');
                 break;
             case HMMState::I:
-                states_sequence.insert(0, 1,'I');
-                sequence.insert(0, 1, sequences_.back()[current_cell.second - 1]);
+                states_sequence.push_back('I');
+                aligned_sequence.push_back(sequence[cell_j - 1]);
                 break;
             case HMMState::None:
                 break;
         }
-        // État suivant
-        current_cell = B[current_cell.first][current_cell.second];
     }
-    // output : print les séquences
-    std::cout << sequence << std::endl;
-    std::cout << states_sequence << std::endl;
 }
 
-// Reverse find dans la map (alphabet)
-char HMM::find_alphabet_value_of(size_t index) {
-    for (auto & mapping : alphabet) {
-        if (mapping.second == index) {
-            return mapping.first;
+// Étape retour par blocs : les colonnes 0, block, 2 * block... sont sauvegardées pendant le remplissage. Le bloc
+// contenant la case courante est recalculé depuis sa colonne sauvegardée, avec les choix de l'étape retour, puis
+// parcouru jusqu'à sortir du bloc. Avec un seul bloc, c'est la matrice retour complète.
+// Seules les lignes de la bande sont calculées ; les autres doivent valoir -inf. La bande ne faisant que monter d'une
+// colonne à la suivante, il suffit d'effacer, dans le tampon qui contenait la colonne j-2, les lignes sous la bande de
+// la colonne j (celles au dessus n'ont jamais été écrites).
+std::tuple<float, std::string, std::string> HMM::viterbi_traceback(const std::vector<char>& sequence,
+                                                                   const std::vector<std::uint8_t>& residues,
+                                                                   std::size_t block, const ViterbiBand& band) const {
+    const float minus_infinity = -1 * std::numeric_limits<float>::infinity();
+    const auto rows = viterbi_rows();
+    const std::size_t height = rows.size();
+    // Choix de l'étape retour d'une colonne : 2 bits par ligne, 32 lignes par mot
+    const std::size_t words = (height + 31) / 32;
+    const std::size_t length = residues.size();
+    if (length == 0) {
+        return {minus_infinity, {}, {}};
+    }
+    block = std::max<std::size_t>(std::min(block, length), 1);
+    // Par blocs, la matrice est remplie deux fois
+    Stats::add(Stats::Counter::cells, std::min(band.size, 2 * band.width + 1) * length * (block < length ? 2 : 1));
+    std::vector<float> checkpoints(((length - 1) / block + 1) * height, minus_infinity);
+    std::vector<float> previous(height, minus_infinity);
+    std::vector<float> current(height, minus_infinity);
+    // Colonne j dans current, à partir de previous, puis échange des deux colonnes
+    auto next_column = [&](std::size_t j, std::uint64_t *column_choices) {
+        if (j >= 2) {
+            std::fill(current.begin() + static_cast<long>(band.first_row(j - 2)),
+                      current.begin() + static_cast<long>(band.first_row(j)), minus_infinity);
+        }
+        viterbi_column(rows, previous.data(), current.data(), residues[j - 1], column_choices, band.first_row(j),
+                       band.last_row(j));
+        std::swap(previous, current);
+    };
+    // Colonne 0 : -inf partout sauf V[0][0]
+    checkpoints[0] = 0;
+    if (block < length) {
+        Stats::Timer timer(Stats::Stage::fill);
+        std::copy(checkpoints.begin(), checkpoints.begin() + static_cast<long>(height), previous.begin());
+        for (std::size_t j = 1; j < length; j++) {
+            next_column(j, nullptr);
+            if (j % block == 0) {
+                std::copy(previous.begin(), previous.end(),
+                          checkpoints.begin() + static_cast<long>((j / block) * height));
+            }
+        }
+    }
+
+    // Étape retour : construction des états et de la séquence alignée : on part de la case en bas à droite de V.
+    // Les états sont ajoutés à la fin puis les chaînes retournées, plutôt qu'insérés au début.
+    std::string aligned_sequence{};
+    std::string states_sequence{};
+    std::vector<std::uint64_t> choices(block * words);
+    std::size_t cell_i = height - 1;
+    std::size_t cell_j = length;
+    std::size_t start = ((length - 1) / block) * block;
+    // Score : la case en bas à droite, calculée avec le dernier bloc
+    float score = minus_infinity;
+    while (cell_j > 0) {
+        // Recalcul des colonnes start + 1 à start + block (ou L) depuis la colonne sauvegardée start
+        {
+            Stats::Timer timer(Stats::Stage::fill);
+            std::copy(checkpoints.begin() + static_cast<long>((start / block) * height),
+                      checkpoints.begin() + static_cast<long>((start / block + 1) * height), previous.begin());
+            std::fill(current.begin(), current.end(), minus_infinity);
+            for (std::size_t j = start + 1; j <= std::min(start + block, length); j++) {
+                next_column(j, choices.data() + (j - start - 1) * words);
+            }
+        }
+        if (cell_j == length) {
+            score = previous[height - 1];
+        }
+        // Parcours du bloc, tant que la case courante y est
+        Stats::Timer timer(Stats::Stage::traceback);
+        trace_block(rows, sequence, choices.data(), words, start, cell_i, cell_j, aligned_sequence, states_sequence);
+        if (start == 0) {
+            break;
+        }
+        start -= block;
+    }
+    // Les états ont été ajoutés à l'envers
+    std::reverse(aligned_sequence.begin(), aligned_sequence.end());
+    std::reverse(states_sequence.begin(), states_sequence.end());
+    return {score, aligned_sequence, states_sequence};
+}
+
+// Score de viterbi dans la bande, en mémoire linéaire. Chaque case retient si le meilleur chemin qui y mène passe par le
+// bord de la bande : c'est le cas de la case précédente retenue (voir les choix de viterbi_column), ou de la case
+// elle-même.
+float HMM::banded_score(const std::vector<std::uint8_t>& residues, const ViterbiBand& band, bool& touched) const {
+    Stats::Timer timer(Stats::Stage::fill);
+    Stats::add(Stats::Counter::cells, std::min(band.size, 2 * band.width + 1) * residues.size());
+    const float minus_infinity = -1 * std::numeric_limits<float>::infinity();
+    const auto rows = viterbi_rows();
+    const std::size_t height = rows.size();
+    std::vector<float> previous(height, minus_infinity);
+    std::vector<float> current(height, minus_infinity);
+    std::vector<std::uint8_t> previous_touched(height, 0);
+    std::vector<std::uint8_t> current_touched(height, 0);
+    std::vector<std::uint64_t> choices((height + 31) / 32);
+    // Colonne 0 : -inf partout sauf V[0][0]
+    previous[0] = 0;
+    for (std::size_t j = 1; j <= residues.size(); j++) {
+        const std::size_t first = band.first_row(j);
+        const std::size_t last = band.last_row(j);
+        // Comme dans viterbi_traceback : current contenait la colonne j-2
+        if (j >= 2) {
+            std::fill(current.begin() + static_cast<long>(band.first_row(j - 2)),
+                      current.begin() + static_cast<long>(first), minus_infinity);
+        }
+        viterbi_column(rows, previous.data(), current.data(), residues[j - 1], choices.data(), first, last);
+        for (std::size_t i = first; i <= last; i++) {
+            const auto & row = rows[i];
+            const std::size_t choice = (choices[i / 32] >> (2 * (i % 32))) & 3;
+            const auto & before = row.j_mod == 1 ? previous_touched : current_touched;
+            current_touched[i] = before[i - row.i_mod - choice] | band.edge(i, j);
+        }
+        std::swap(previous, current);
+        std::swap(previous_touched, current_touched);
+    }
+    // Sans chemin dans la bande, le calcul complet décide
+    touched = previous_touched[height - 1] != 0 || previous[height - 1] == minus_infinity;
+    return previous[height - 1];
+}
+
+// Viterbi local ou glocal : la matrice de viterbi, dont l'état M0 de chaque colonne est l'état B, est complétée par les
+// états de flanc, une valeur par colonne. Les acides aminés de flanc coûtent log(1/20) chacun : le chemin émet toute la
+// séquence, et son score moins L log(1/20) est son log-odds. J et C ne gardent que le meilleur état E d'où ils viennent
+// (leur coût ne dépend que du nombre d'acides aminés émis depuis).
+float HMM::local_viterbi(const std::vector<char>& sequence, const std::vector<std::uint8_t>& residues,
+                         const AlignOptions& options, std::vector<Alignment> *hits) const {
+    const float minus_infinity = -1 * std::numeric_limits<float>::infinity();
+    const auto rows = viterbi_rows();
+    const std::size_t height = rows.size();
+    const std::size_t words = (height + 31) / 32;
+    const std::size_t length = residues.size();
+    const auto size = static_cast<std::size_t>(N_);
+    const bool local = options.mode == Mode::local;
+    const float null_score = std::log(1.0f / Alphabet::size);
+    const float entry = local && size > 1 ? std::log(2.0f / static_cast<float>(size * (size - 1))) : minus_infinity;
+    // E -> C et E -> J
+    const float exit = options.multiple ? std::log(0.5f) : 0;
+    const float loop = options.multiple ? std::log(0.5f) : minus_infinity;
+    // Sans chemin : la position d'un état E inexistant
+    constexpr std::size_t none = SIZE_MAX;
+    if (length == 0) {
+        return minus_infinity;
+    }
+    Stats::add(Stats::Counter::cells, size * length);
+    std::optional<Stats::Timer> fill(std::in_place, Stats::Stage::fill);
+    // B[j], E[j] et la ligne d'où vient E[j] (l'état final, ou un état M en mode local), et pour B[j] venant de J, la
+    // colonne de l'état E du domaine précédent
+    std::vector<float> begin(length + 1, minus_infinity);
+    std::vector<float> end(length + 1, minus_infinity);
+    std::vector<std::size_t> end_row(length + 1, height - 1);
+    std::vector<std::size_t> resume(length + 1, none);
+    std::vector<std::uint64_t> choices(hits != nullptr ? length * words : 0);
+    std::vector<float> previous(height, minus_infinity);
+    std::vector<float> current(height, minus_infinity);
+    // En mode local, un domaine ne commence que par une entrée directe (M1 compris) : l'état M0 reste à -inf
+    begin[0] = 0;
+    previous[0] = local ? minus_infinity : 0;
+    // Meilleur E[e] + log(E -> J) - e log(1/20) parmi les colonnes déjà calculées
+    float best_loop = minus_infinity;
+    std::size_t best_loop_column = none;
+    for (std::size_t j = 1; j <= length; j++) {
+        // B[j] : depuis N (j acides aminés de flanc) ou J (au moins un acide aminé après la fin du domaine précédent)
+        if (end[j - 1] + loop - static_cast<float>(j - 1) * null_score > best_loop) {
+            best_loop = end[j - 1] + loop - static_cast<float>(j - 1) * null_score;
+            best_loop_column = j - 1;
+        }
+        begin[j] = static_cast<float>(j) * null_score;
+        if (best_loop + static_cast<float>(j) * null_score > begin[j]) {
+            begin[j] = best_loop + static_cast<float>(j) * null_score;
+            resume[j] = best_loop_column;
+        }
+        viterbi_column(rows, previous.data(), current.data(), residues[j - 1],
+                       hits != nullptr ? choices.data() + (j - 1) * words : nullptr, 2, height - 1,
+                       local ? minus_infinity : begin[j], begin[j - 1] + entry);
+        end[j] = current[height - 1];
+        for (std::size_t k = 1; local && k < size; k++) {
+            if (current[3 * k] > end[j]) {
+                end[j] = current[3 * k];
+                end_row[j] = 3 * k;
+            }
+        }
+        std::swap(previous, current);
+    }
+    // Fin du chemin : le meilleur E[e] + log(E -> C), suivi de L - e acides aminés de flanc
+    std::size_t last = none;
+    float best = minus_infinity;
+    for (std::size_t e = 1; e <= length; e++) {
+        const float score = end[e] + exit + static_cast<float>(length - e) * null_score;
+        if (score > best) {
+            best = score;
+            last = e;
+        }
+    }
+    fill.reset();
+    if (hits == nullptr || last == none) {
+        return best - static_cast<float>(length) * null_score;
+    }
+
+    // Étape retour : chaque domaine, du dernier au premier, depuis son état E jusqu'à l'état M0 (B) ou une entrée
+    // directe ; le domaine précédent finit à la colonne resume du début de celui-ci
+    Stats::Timer timer(Stats::Stage::traceback);
+    for (std::size_t e = last; e != none; ) {
+        Alignment hit;
+        std::size_t cell_i = end_row[e];
+        std::size_t cell_j = e;
+        auto choice_at = [&]() {
+            return (choices[(cell_j - 1) * words + cell_i / 32] >> (2 * (cell_i % 32))) & 3;
+        };
+        // L'état final n'est pas un état du domaine : départ de la case qui le précède
+        if (cell_i == height - 1) {
+            cell_i -= rows[cell_i].i_mod + choice_at();
+        }
+        std::size_t start;
+        while (true) {
+            if (cell_i == 0) {
+                start = cell_j;
+                break;
+            }
+            const auto state = static_cast<HMMState>(cell_i % 3);
+            hit.states.push_back("MDI"[cell_i % 3]);
+            hit.sequence.push_back(state == HMMState::D ? '-' : sequence[cell_j - 1]);
+            if (state == HMMState::M) {
+                // Parcours à l'envers : le premier état M rencontré est le dernier du domaine
+                if (hit.sequence_end == 0) {
+                    hit.sequence_end = cell_j;
+                    hit.model_end = cell_i / 3 + 1;
+                }
+                hit.sequence_begin = cell_j - 1;
+                hit.model_begin = cell_i / 3;
+            }
+            const std::size_t choice = choice_at();
+            if (choice == 3) {
+                start = cell_j - 1;
+                break;
+            }
+            const auto & row = rows[cell_i];
+            cell_i -= row.i_mod + choice;
+            cell_j -= row.j_mod;
+        }
+        std::reverse(hit.sequence.begin(), hit.sequence.end());
+        std::reverse(hit.states.begin(), hit.states.end());
+        hit.score = end[e] - begin[start] - static_cast<float>(e - start) * null_score;
+        hits->push_back(std::move(hit));
+        e = resume[start];
+    }
+    std::reverse(hits->begin(), hits->end());
+    return best - static_cast<float>(length) * null_score;
+}
+
+// Score de viterbi seul, en mémoire linéaire : seules la colonne j-1 et la colonne j de V sont conservées.
+// Les lignes sont parcourues par rang k du modèle (M_k, D_k, I_k), les valeurs sont celles de la matrice complète.
+float HMM::viterbi_score(const std::vector<std::uint8_t>& residues) const {
+    Stats::Timer timer(Stats::Stage::fill);
+    Stats::add(Stats::Counter::cells, static_cast<std::size_t>(N_) * residues.size());
+    const float minus_infinity = -1 * std::numeric_limits<float>::infinity();
+    const auto rows = static_cast<std::size_t>(3 * N_ + 1);
+    // Colonne 0 : -inf partout sauf V[0][0]
+    std::vector<float> previous(rows, minus_infinity);
+    std::vector<float> current(rows, minus_infinity);
+    previous[0] = 0;
+    if (residues.empty()) {
+        return minus_infinity;
+    }
+    for (auto residue : residues) {
+        // Rang 0 : M0 et D0 valent -inf (les colonnes sont réutilisées, V[0][0] doit être effacé), seul I0 est calculé
+        current[0] = minus_infinity;
+        const float *t = profile_.transition(0);
+        current[2] = profile_.insert(0)[residue] +
+                std::max({previous[2] + t[8], previous[1] + t[5], previous[0] + t[2]});
+        for (std::size_t k = 1; k < static_cast<std::size_t>(N_); k++) {
+            const float *t_before = profile_.transition(k - 1);
+            t = profile_.transition(k);
+            const std::size_t i = 3 * k;
+            // M_k : depuis le rang k-1, colonne précédente
+            current[i] = profile_.match(k)[residue] +
+                    std::max({previous[i - 1] + t_before[6], previous[i - 2] + t_before[3],
+                              previous[i - 3] + t_before[0]});
+            // D_k : depuis le rang k-1, même colonne
+            current[i + 1] = std::max({current[i - 1] + t_before[7], current[i - 2] + t_before[4],
+                                       current[i - 3] + t_before[1]});
+            // I_k : depuis le rang k, colonne précédente
+            current[i + 2] = profile_.insert(k)[residue] +
+                    std::max({previous[i + 2] + t[8], previous[i + 1] + t[5], previous[i] + t[2]});
         }
+        std::swap(previous, current);
+    }
+    // État final, dans la dernière colonne
+    const float *t = profile_.transition(N_ - 1);
+    const std::size_t i = rows - 1;
+    return std::max({previous[i - 1] + t[6], previous[i - 2] + t[3], previous[i - 3] + t[0]});
+}
+
+// Colonne j de la matrice Forward : même parcours que viterbi_score, par rang k du modèle
+void HMM::forward_column(const float *previous, float *current, std::uint8_t residue) const {
+    const float minus_infinity = -1 * std::numeric_limits<float>::infinity();
+    const auto end = static_cast<std::size_t>(3 * N_);
+    // Rang 0 : M0 et D0 valent -inf, seul I0 est calculé
+    current[0] = minus_infinity;
+    current[1] = minus_infinity;
+    const float *t = profile_.transition(0);
+    current[2] = profile_.insert(0)[residue] + LogSum::add(previous[2] + t[8], previous[1] + t[5], previous[0] + t[2]);
+    for (std::size_t k = 1; k < static_cast<std::size_t>(N_); k++) {
+        const float *t_before = profile_.transition(k - 1);
+        t = profile_.transition(k);
+        const std::size_t i = 3 * k;
+        // M_k : depuis le rang k-1, colonne précédente
+        current[i] = profile_.match(k)[residue] +
+                LogSum::add(previous[i - 1] + t_before[6], previous[i - 2] + t_before[3], previous[i - 3] + t_before[0]);
+        // D_k : depuis le rang k-1, même colonne
+        current[i + 1] = LogSum::add(current[i - 1] + t_before[7], current[i - 2] + t_before[4],
+                                     current[i - 3] + t_before[1]);
+        // I_k : depuis le rang k, colonne précédente
+        current[i + 2] = profile_.insert(k)[residue] +
+                LogSum::add(previous[i + 2] + t[8], previous[i + 1] + t[5], previous[i] + t[2]);
     }
-    return 0;
+    // État final, dans la même colonne
+    t = profile_.transition(N_ - 1);
+    current[end] = LogSum::add(current[end - 1] + t[6], current[end - 2] + t[3], current[end - 3] + t[0]);
 }
 
-// Surcharge de display_matrix pour écrire la matrice de paire. Utilisée en débug pour écrire B la matrice retour de
-// HMM-align
-void HMM::display_matrix(std::vector<std::vector<std::pair<int, int>>> matrix) {
-    for (auto & line : matrix) {
-        for (std::size_t j = 0; j < line.size(); j++) {
-                std::cout << line[j].first << "," << line[j].second;
-            if (j != line.size() - 1) {
-                std::cout << ' ';
+// Colonne j de la matrice Backward : les rangs sont parcourus de N-1 à 0, D_k+1 (même colonne) étant calculé avant les
+// états du rang k
+void HMM::backward_column(const float *next, float *current, std::uint8_t residue, bool last) const {
+    const float minus_infinity = -1 * std::numeric_limits<float>::infinity();
+    const auto size = static_cast<std::size_t>(N_);
+    const std::size_t end = 3 * size;
+    // L'état final n'est atteint que dans la dernière colonne
+    current[end] = last ? 0 : minus_infinity;
+    for (std::size_t k = size; k-- > 0;) {
+        const float *t = profile_.transition(k);
+        const std::size_t i = 3 * k;
+        // Successeurs possibles des états du rang k : M_k+1 (colonne suivante ; l'état final, dans la même colonne,
+        // après le dernier rang), D_k+1 (même colonne) et I_k (colonne suivante)
+        float to_match = minus_infinity;
+        float to_delete = minus_infinity;
+        float to_insert = minus_infinity;
+        if (k + 1 == size) {
+            to_match = current[end];
+        } else {
+            to_match = last ? minus_infinity : profile_.match(k + 1)[residue] + next[i + 3];
+            to_delete = current[i + 4];
+        }
+        if (not last) {
+            to_insert = profile_.insert(k)[residue] + next[i + 2];
+        }
+        // M_k, D_k, I_k : ligne 3 * état de la matrice de transition
+        for (std::size_t state = 0; state < 3; state++) {
+            current[i + state] = LogSum::add(t[3 * state] + to_match, t[3 * state + 1] + to_delete,
+                                             t[3 * state + 2] + to_insert);
+        }
+    }
+}
+
+// Score Forward seul, en mémoire linéaire : seules la colonne j-1 et la colonne j de F sont conservées
+float HMM::forward_score(const std::vector<std::uint8_t>& residues) const {
+    Stats::Timer timer(Stats::Stage::fill);
+    Stats::add(Stats::Counter::cells, static_cast<std::size_t>(N_) * residues.size());
+    const float minus_infinity = -1 * std::numeric_limits<float>::infinity();
+    const auto rows = static_cast<std::size_t>(3 * N_ + 1);
+    // Colonne 0 : -inf partout sauf F[0][0]
+    std::vector<float> previous(rows, minus_infinity);
+    std::vector<float> current(rows, minus_infinity);
+    previous[0] = 0;
+    if (residues.empty()) {
+        return minus_infinity;
+    }
+    for (auto residue : residues) {
+        forward_column(previous.data(), current.data(), residue);
+        std::swap(previous, current);
+    }
+    return previous[rows - 1];
+}
+
+// Colonne j de la matrice d'exactitude, dans le même ordre et avec les mêmes égalités que viterbi_column
+void HMM::accuracy_column(const std::vector<ViterbiRow>& rows, const float *previous, float *current,
+                          const float *gain, std::uint64_t *choices) {
+    current[0] = -1 * std::numeric_limits<float>::infinity();
+    current[1] = -1 * std::numeric_limits<float>::infinity();
+    std::uint64_t word = 0;
+    for (std::size_t i = 2; i < rows.size(); i++) {
+        const auto & row = rows[i];
+        const float *column = row.j_mod == 1 ? previous : current;
+        float max_value = -1 * std::numeric_limits<float>::infinity();
+        std::uint64_t choice = 2;
+        for (int tmp_mod = 0; tmp_mod < 3; tmp_mod++) {
+            float tmp = column[i - row.i_mod - tmp_mod] + row.log_transition[tmp_mod];
+            if (tmp >= max_value) {
+                max_value = tmp;
+                choice = tmp_mod;
+            }
+        }
+        current[i] = gain[i] + max_value;
+        word |= choice << (2 * (i % 32));
+        if (i % 32 == 31) {
+            choices[i / 32] = word;
+            word = 0;
+        }
+    }
+    if (rows.size() % 32 != 0) {
+        choices[rows.size() / 32] = word;
+    }
+}
+
+// Décodage postérieur. La matrice Forward est gardée en entier : la colonne j y est remplacée par le gain de ses cases
+// dès que la colonne j de Backward est connue, puis l'alignement d'exactitude maximale est calculé comme celui de
+// viterbi, avec son étape retour.
+std::tuple<float, std::string, std::string> HMM::posterior_traceback(const std::vector<char>& sequence,
+                                                                    const std::vector<std::uint8_t>& residues) const {
+    const float minus_infinity = -1 * std::numeric_limits<float>::infinity();
+    const auto rows = viterbi_rows();
+    const std::size_t height = rows.size();
+    const std::size_t words = (height + 31) / 32;
+    const std::size_t length = residues.size();
+    if (length == 0) {
+        return {minus_infinity, {}, {}};
+    }
+    // Forward, Backward et exactitude : trois passes sur la matrice
+    Stats::add(Stats::Counter::cells, 3 * static_cast<std::size_t>(N_) * length);
+    std::optional<Stats::Timer> fill(std::in_place, Stats::Stage::fill);
+    // Forward : colonne 0 à -inf partout sauf F[0][0]
+    std::vector<float> forward((length + 1) * height, minus_infinity);
+    forward[0] = 0;
+    for (std::size_t j = 1; j <= length; j++) {
+        forward_column(&forward[(j - 1) * height], &forward[j * height], residues[j - 1]);
+    }
+    const float score = forward[length * height + height - 1];
+    // Aucun chemin n'émet la séquence
+    if (score == minus_infinity) {
+        return {score, {}, {}};
+    }
+    // Backward, de la colonne L à la colonne 1. Le gain d'une case est sa probabilité postérieure
+    // exp(F + B - score) pour M et I, 0 pour D et l'état final, -inf si aucun chemin n'y passe.
+    std::vector<float> next(height, minus_infinity);
+    std::vector<float> current(height, minus_infinity);
+    for (std::size_t j = length; j >= 1; j--) {
+        backward_column(next.data(), current.data(), j < length ? residues[j] : 0, j == length);
+        float *gain = &forward[j * height];
+        for (std::size_t i = 0; i < height; i++) {
+            const float posterior = gain[i] + current[i] - score;
+            if (posterior == minus_infinity) {
+                gain[i] = minus_infinity;
             } else {
-                std::cout << std::endl;
+                gain[i] = rows[i].j_mod == 1 ? std::exp(posterior) : 0;
             }
         }
+        std::swap(next, current);
     }
-}
\ No newline at end of file
+
+    // Alignement d'exactitude maximale : seules les transitions possibles sont gardées, sans leur probabilité
+    auto accuracy_rows = rows;
+    for (auto & row : accuracy_rows) {
+        for (auto & log_transition : row.log_transition) {
+            log_transition = log_transition == minus_infinity ? minus_infinity : 0;
+        }
+    }
+    std::vector<std::uint64_t> choices(length * words);
+    std::vector<float> previous(height, minus_infinity);
+    previous[0] = 0;
+    for (std::size_t j = 1; j <= length; j++) {
+        accuracy_column(accuracy_rows, previous.data(), current.data(), &forward[j * height],
+                        choices.data() + (j - 1) * words);
+        std::swap(previous, current);
+    }
+    fill.reset();
+    Stats::Timer timer(Stats::Stage::traceback);
+    std::string aligned_sequence{};
+    std::string states_sequence{};
+    std::size_t cell_i = height - 1;
+    std::size_t cell_j = length;
+    trace_block(accuracy_rows, sequence, choices.data(), words, 0, cell_i, cell_j, aligned_sequence, states_sequence);
+    std::reverse(aligned_sequence.begin(), aligned_sequence.end());
+    std::reverse(states_sequence.begin(), states_sequence.end());
+    return {score, aligned_sequence, states_sequence};
+}
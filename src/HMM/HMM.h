@@ -6,55 +6,247 @@
 #define PROJET_BIOINFO_WIRTH_HMM_H
 
 
+#include <algorithm>
+#include <limits>
 #include <vector>
 #include <optional>
-#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <tuple>
 #include "Fasta.h"
+#include "MappedFile.h"
+#include "Matrix.h"
+#include "Output.h"
+#include "Profile.h"
+#include "Ssv.h"
+#include "Striped.h"
+#include "Striped16.h"
+#include "TextModel.h"
 
+/**
+ * Modèle de Markov caché "Plan 9" : construction (HMM-build), chargement, alignement (HMM-align, HMM-search) et tirage
+ * de séquences (HMM-genseq). Un modèle construit ou chargé n'est plus modifié : ses méthodes const peuvent être appelées
+ * depuis plusieurs threads à la fois.
+ */
 class HMM {
 public:
     // CTOR
     /**
-     * Constructeur depuis un Fasta et un alpha fournis, utilisé pour HMM-build
-     * @param fasta le fasta à partir d'une liste de séquences
-     * @param alpha paramètre arbitraire entre 0 et 1
+     * Constructeur à partir d'un fichier .model, utilisé pour HMM-align & HMM-genseq.
+     * Le format (texte ou binaire) est reconnu automatiquement.
+     * @param model_file
+     * @throws std::runtime_error si le fichier ne peut pas être lu, si le modèle est invalide, ou si le fichier contient
+     * plusieurs modèles (voir load_library)
      */
-    explicit HMM(Fasta fasta, float alpha);
+    explicit HMM(const std::string& model_file);
 
     /**
-     * Constructeur à partir d'un fichier .model, utilisé pour HMM-align & HMM-genseq
-     * @param model_file
+     * Chargement d'une bibliothèque : un fichier contenant plusieurs modèles à la suite (fichiers .model concaténés,
+     * texte ou binaires, voir TextModel et BinaryModel). Le fichier est projeté en mémoire et lu une fois.
+     * Un modèle texte peut être précédé d'une ligne '>nom' ; les autres sont nommés d'après le fichier, sans répertoire
+     * ni extension, suivi de ":k" (k-ième modèle, à partir de 1) s'il y a plusieurs modèles.
+     * @param library_file le fichier
+     * @return les modèles, dans l'ordre du fichier
+     * @throws std::runtime_error si le fichier ne peut pas être lu ou si un modèle est invalide
      */
-    explicit HMM(const std::string& model_file);
+    static std::vector<HMM> load_library(const std::string& library_file);
+
+    /**
+     * Construction de plusieurs modèles à partir d'un même fasta, un par alpha, en un seul parcours du fichier (HMM-build
+     * avec plusieurs alpha). Les gaps de chaque colonne sont comptés une fois pour tous les alpha ; chaque séquence est
+     * digitalisée une fois puis comptée pour chaque ensemble distinct de colonnes marquées, les alpha qui marquent les
+     * mêmes colonnes partageant le même modèle.
+     * @param fasta le fasta des séquences alignées
+     * @param alphas les seuils des colonnes marquées, entre 0 et 1
+     * @param threads nombre de threads de la construction (0 : autant que de coeurs)
+     * @return les modèles construits, dans l'ordre des alpha
+     */
+    static std::vector<HMM> build_models(const Fasta& fasta, const std::vector<float>& alphas, unsigned threads = 0);
+
+    /**
+     * Résultat de l'alignement d'une séquence (ou de la séquence la plus probable, voir most_probable_sequence)
+     */
+    struct Alignment {
+        // Log de la probabilité de la séquence : score de viterbi, ou score Forward avec l'option posterior
+        float score = 0;
+        // Séquence alignée et séquence d'états (vides avec l'option score)
+        std::string sequence;
+        std::string states;
+        // Coordonnées de la partie alignée sur des états M, de la première à la dernière : acides aminés
+        // [sequence_begin, sequence_end) de la séquence sans gap (à partir de 0), rangs [model_begin, model_end) du
+        // modèle (l'état M_k étant au rang k, à partir de 1). Toutes à 0 sans état M (et avec l'option score).
+        std::size_t sequence_begin = 0;
+        std::size_t sequence_end = 0;
+        std::size_t model_begin = 0;
+        std::size_t model_end = 0;
+    };
 
     /**
-     * Construction du modèle "Plan 9" selon l'algorithme décrit dans la step 1
+     * Step 2 - HMM-genseq : séquence la plus probable, état après état
+     * @return la séquence (les états D y sont des '-'), sa séquence d'états et ses coordonnées ; le score est le log de
+     * la probabilité du chemin d'états et de la séquence
      */
-    void build_model();
+    [[nodiscard]] Alignment most_probable_sequence() const;
 
     /**
-     * Step 2 - HMM-genseq
+     * HMM-genseq --sample : tirage aléatoire de count séquences selon le modèle, écrites au format fasta (voir Sampler)
+     * @param count le nombre de séquences
+     * @param seed la graine : les séquences ne dépendent que d'elle, quel que soit le nombre de threads
+     * @param threads nombre de threads (0 : autant que de coeurs)
+     * @param out le flux de sortie
      */
-    void build_print_genseq();
+    void sample_genseq(std::size_t count, std::uint64_t seed, unsigned threads, std::ostream& out) const;
 
     /**
      * Écriture du modèle - HMM-build
+     * @param out le flux de sortie
+     */
+    void print_model(std::ostream& out) const;
+
+    /**
+     * Écriture du modèle au format binaire (voir BinaryModel), chargé sans copie par le constructeur depuis un fichier
+     * @param out le flux de sortie
+     */
+    void print_binary_model(std::ostream& out) const;
+
+    /**
+     * Mode d'alignement : global (le chemin couvre tout le modèle et toute la séquence), glocal (tout le modèle, sur une
+     * partie de la séquence) ou local (une partie du modèle, sur une partie de la séquence). Hors du mode global, les
+     * acides aminés hors du domaine sont émis selon le modèle nul (acides aminés équiprobables), et les scores sont des
+     * log-odds contre ce modèle (en nats).
+     */
+    enum class Mode {
+        global,
+        glocal,
+        local
+    };
+
+    /**
+     * Options de l'alignement - HMM-align
      */
-    void print_model() const;
+    struct AlignOptions {
+        // Vrai s'il faut retourner le score uniquement, faux sinon
+        bool score = false;
+        // Mémoire maximale (en octets) de l'étape retour, 0 pour ne pas la limiter. Au delà, l'étape retour
+        // recalcule la matrice par blocs à partir de colonnes sauvegardées (checkpoints)
+        std::size_t max_memory = 0;
+        // Vrai pour le score Forward (somme sur tous les chemins) et l'alignement d'exactitude maximale (décodage
+        // postérieur), faux pour le score et le chemin de viterbi
+        bool posterior = false;
+        // Largeur de la bande de viterbi (en rangs du modèle de part et d'autre de la diagonale), 0 pour calculer la
+        // matrice entière. Si le meilleur chemin de la bande en touche le bord, la matrice entière est calculée.
+        std::size_t band = 0;
+        // Mode d'alignement. Les options posterior, band et max_memory ne s'appliquent qu'au mode global.
+        Mode mode = Mode::global;
+        // Hors du mode global : plusieurs domaines disjoints par séquence (voir align_hits), plutôt que le meilleur
+        bool multiple = false;
+        // Score seul de viterbi en mode global : calcul en entiers 16 bits (voir Striped16), à l'écart d'arrondi près,
+        // recalculé en flottants s'il sature
+        bool integer = false;
+    };
 
     /**
-     * Algorithme de viterbi & étape retour - HMM-align
-     * @param score Vrai s'il faut retourner le score uniquement, faux sinon
+     * Vérification d'une combinaison d'options, à faire une fois avant de lancer des threads : align, align_sequence,
+     * align_hits et score lèvent la même exception
+     * @param options options de l'alignement
+     * @throws std::invalid_argument pour l'option posterior hors du mode global
      */
-    void viterbi(bool score);
+    static void check_options(const AlignOptions& options);
 
     /**
-     * Setter
-     * @param sequences liste de sequences à déplacer dans la variable sequences_
+     * Algorithme de viterbi & étape retour sur une séquence quelconque - HMM-align, sous forme de texte : le score
+     * (options score et posterior), puis la séquence alignée et la séquence d'états (sauf option score), une ligne
+     * chacun
+     * @param sequence la séquence à aligner sur le modèle
+     * @param options options de l'alignement
+     * @return le texte de l'alignement
      */
-    void set_sequences(std::vector<std::vector<char>> sequences);
+    [[nodiscard]] std::string align(const std::vector<char>& sequence, const AlignOptions& options) const;
+
+    /**
+     * Alignement d'une séquence, comme align, sous forme structurée plutôt que de texte. Ne modifie pas le modèle : peut
+     * être appelé depuis plusieurs threads sur le même modèle.
+     * @param sequence la séquence à aligner sur le modèle
+     * @param options options de l'alignement
+     * @return le score, la séquence alignée, la séquence d'états et les coordonnées de l'alignement ; hors du mode
+     * global, ceux du domaine de meilleur score (avec l'option score, le score du chemin)
+     * @throws std::invalid_argument pour l'option posterior hors du mode global
+     */
+    [[nodiscard]] Alignment align_sequence(const std::vector<char>& sequence, const AlignOptions& options) const;
+
+    /**
+     * Domaines d'une séquence, en un seul passage : hors du mode global, chaque domaine du meilleur chemin (un seul
+     * sans l'option multiple), dans l'ordre de la séquence, avec son score (log-odds du domaine, entrée comprise),
+     * son alignement et ses coordonnées. En mode global, ou avec l'option score, un seul résultat : celui de
+     * align_sequence.
+     * @param sequence la séquence à aligner sur le modèle
+     * @param options options de l'alignement
+     * @return les domaines (aucun si la séquence ne peut pas être émise)
+     * @throws std::invalid_argument pour l'option posterior hors du mode global
+     */
+    [[nodiscard]] std::vector<Alignment> align_hits(const std::vector<char>& sequence, const AlignOptions& options) const;
+
+    /**
+     * Score d'une séquence déjà digitalisée, sans toucher à l'état de l'objet : celui qu'écrit align avec l'option score
+     * (viterbi, ou Forward avec l'option posterior)
+     * @param residues la séquence digitalisée, sans gap
+     * @param options options de l'alignement
+     * @return le log de la probabilité de la séquence
+     */
+    [[nodiscard]] float score(const std::vector<std::uint8_t>& residues, const AlignOptions& options) const;
+
+    /**
+     * Score du préfiltre SSV (voir Ssv), bien moins cher que score
+     * @param residues la séquence digitalisée, sans gap
+     * @return le log-odds du meilleur segment sans gap sur les états M, en nats
+     */
+    [[nodiscard]] float prefilter_score(const std::vector<std::uint8_t>& residues) const;
+
+    /**
+     * @return le nombre de rangs N du modèle
+     */
+    [[nodiscard]] std::size_t size() const;
+
+    /**
+     * @return le nom du modèle (voir load_library), vide pour un modèle construit par HMM-build
+     */
+    [[nodiscard]] const std::string& name() const;
 
 private:
+    /**
+     * Modèle à construire à partir de colonnes marquées déjà calculées (voir build_models) : matrices initialisées aux
+     * pseudo-comptes
+     * @param marked_columns les colonnes marquées
+     */
+    explicit HMM(std::vector<bool> marked_columns);
+    /**
+     * Modèle vide, rempli par load (voir load_library)
+     */
+    HMM() = default;
+    /**
+     * Dimensionnement de la HMM d'après les colonnes marquées, et initialisation des matrices aux pseudo-comptes
+     */
+    void init_build_matrices();
+    /**
+     * Chargement du modèle commençant à la position offset d'un fichier projeté, texte ou binaire
+     * @param file le fichier projeté, gardé en vie par le profil compilé (modèle binaire)
+     * @param offset la position du modèle dans le fichier
+     * @return la position qui suit le modèle (et les blancs qui le suivent)
+     */
+    std::size_t load(const std::shared_ptr<const MappedFile>& file, std::size_t offset);
+    /**
+     * Chargement d'un modèle binaire projeté en mémoire
+     * @param file le fichier projeté, gardé en vie par le profil compilé
+     * @param offset la position du modèle dans le fichier, multiple de 64
+     * @return la taille du modèle en octets
+     */
+    std::size_t load_binary_model(const std::shared_ptr<const MappedFile>& file, std::size_t offset);
+    /**
+     * Chargement d'un modèle texte (voir TextModel)
+     * @param reader le texte, positionné au début du modèle
+     */
+    void load_text_model(TextModel& reader);
     /**
      * Normalisation des matrices selon les modalités de la step 1
      */
@@ -70,55 +262,265 @@ private:
         I = 2,
         None = 3
     };
-    // Correspondance globale encodage acide aminé - entier (représenté en size_t pour la cohérence des types)
-    static std::map<const char, std::size_t> alphabet;
-    // Recherche inversée dans la map ci dessus
-    static char find_alphabet_value_of(size_t index);
-    // Recherche du caractère d'émission le plus probable du vecteur vector.
-    static char most_probable_char(std::vector<std::optional<float>> &vector);
-    // Tests sur les résultats non concluants, mais pour la forme
-    static void round_matrix(std::vector<std::vector<std::optional<float>>> matrix);
+    // Recherche du caractère d'émission le plus probable de la ligne line (20 valeurs).
+    static char most_probable_char(const float *line);
     // HMM-BUILD
     /**
      * Construction de la séquence d'état à partir des séquences de caractères
-     * @param sequence liste des séquences à traiter
+     * @param sequence la séquence digitalisée à traiter
      * @return un vecteur d'état associé aux séquences
      * @note Utilise la liste de colonnes marquées interne à la classe
      */
-    std::vector<HMMState> build_Pi_k(const std::vector<char>& sequence);
+    [[nodiscard]] std::vector<HMMState> build_Pi_k(const std::vector<std::uint8_t>& sequence) const;
 
+    /**
+     * Comptes entiers de la construction, accumulés par un thread sur sa tranche de séquences
+     */
+    struct BuildCounts {
+        // N x 9
+        std::vector<std::uint64_t> T;
+        // N x 20
+        std::vector<std::uint64_t> e_M;
+        std::vector<std::uint64_t> e_I;
+    };
+    /**
+     * Ajout des comptes d'une séquence alignée (transitions et émissions de son chemin d'états)
+     * @param A_k la séquence digitalisée
+     * @param counts les comptes du thread
+     */
+    void count_sequence(const std::vector<std::uint8_t>& A_k, BuildCounts& counts) const;
+    /**
+     * Comptes de toutes les séquences pour plusieurs modèles, puis normalisation de leurs matrices. Les séquences sont
+     * réparties en tranches entre les threads ; chacune est digitalisée une fois pour tous les modèles.
+     * @param records les séquences alignées
+     * @param models les modèles, initialisés aux pseudo-comptes
+     * @param threads le nombre de threads entre lesquels répartir les séquences
+     */
+    static void count_records(const std::vector<Fasta::View>& records, const std::vector<HMM *>& models,
+                              unsigned threads);
+
+    /**
+     * Compte les gaps de chaque colonne de l'alignement (la longueur de la première séquence)
+     * @param records les séquences alignées
+     * @param threads le nombre de threads entre lesquels répartir les séquences
+     * @return le nombre de séquences ayant un gap, pour chaque colonne
+     */
+    static std::vector<std::uint64_t> count_gaps(const std::vector<Fasta::View>& records, unsigned threads);
     /**
      * Calcule les colonnes marquées et renvoie la liste de booléens associée
-     * @param sequences la liste des séquences
+     * @param gaps le nombre de gaps de chaque colonne (voir count_gaps)
+     * @param count le nombre de séquences
      * @param alpha le seuil pour savoir si une colonne est marquée ou non
      * @return une liste de booléen ayant pour valeur true si la colonne est marquée, false sinon
      */
-    static std::vector<bool> get_marked_columns(const std::vector<std::vector<char>>& sequences, float alpha);
+    static std::vector<bool> get_marked_columns(const std::vector<std::uint64_t>& gaps, std::size_t count, float alpha);
 
     // HMM-ALIGN
+    /**
+     * Ligne i de la matrice de viterbi : tout ce qui ne dépend que de la ligne (voir align)
+     */
+    struct ViterbiRow {
+        // Modificateurs d'index sur i et j des 3 états précédents possibles
+        int i_mod;
+        int j_mod;
+        // Ligne d'émission du profil (nullptr pour D et l'état final : constante nulle)
+        const float *emission;
+        // log(T[][]) des 3 états précédents possibles, indicés par tmp_mod
+        float log_transition[3];
+    };
+    /**
+     * Bande de la matrice de viterbi : dans la colonne j, seuls les rangs k à au plus width de la diagonale
+     * round(j N / L) sont calculés, les autres valent -inf. La bande monte avec j, et contient V[0][0] et l'état final.
+     */
+    struct ViterbiBand {
+        std::size_t width;
+        // N et L
+        std::size_t size;
+        std::size_t length;
+
+        [[nodiscard]] std::size_t center(std::size_t j) const { return (j * size + length / 2) / length; }
+        [[nodiscard]] std::size_t low(std::size_t j) const { return center(j) > width ? center(j) - width : 0; }
+        [[nodiscard]] std::size_t high(std::size_t j) const { return std::min(size, center(j) + width); }
+        // Première et dernière lignes calculées dans la colonne j
+        [[nodiscard]] std::size_t first_row(std::size_t j) const { return std::max<std::size_t>(2, 3 * low(j)); }
+        [[nodiscard]] std::size_t last_row(std::size_t j) const { return std::min(3 * size, 3 * high(j) + 2); }
+        /**
+         * Vrai si la case (i, j) est au bord de la bande : sur son premier ou dernier rang (sauf aux bords de la
+         * matrice), ou sous le premier rang de la colonne suivante
+         */
+        [[nodiscard]] bool edge(std::size_t i, std::size_t j) const {
+            const std::size_t k = i / 3;
+            return (low(j) > 0 && k == low(j)) || (high(j) < size && k == high(j)) ||
+                   (j < length && k < low(j + 1));
+        }
+    };
+    // Table des lignes 0 à 3N de la matrice de viterbi (les lignes 0 et 1 ne sont jamais calculées)
+    [[nodiscard]] std::vector<ViterbiRow> viterbi_rows() const;
+    /**
+     * Calcul d'une colonne de la matrice de viterbi à partir de la précédente, dans le même ordre et avec les mêmes
+     * égalités que la matrice complète
+     * @param rows la table des lignes
+     * @param previous la colonne j-1
+     * @param current la colonne j, à remplir
+     * @param residue le caractère j-1 de la séquence, digitalisé
+     * @param choices si non nul, reçoit pour chaque ligne le tmp_mod de l'état précédent retenu (étape retour), sur
+     * 2 bits : la ligne i occupe les bits 2 * (i % 32) du mot i / 32
+     * @param first, last les lignes à calculer (2 et 3N pour la colonne entière, voir ViterbiBand) ; les autres ne sont
+     * pas écrites, et doivent valoir -inf
+     * @param start la valeur de l'état M0 dans la colonne j (-inf en mode global : le chemin part de V[0][0])
+     * @param entry la valeur d'une entrée directe dans un état M_k de la colonne j (mode local), retenue avec le choix
+     * 3 si elle dépasse les 3 valeurs précédentes (-inf : pas d'entrée)
+     */
+    static void viterbi_column(const std::vector<ViterbiRow>& rows, const float *previous, float *current,
+                               std::uint8_t residue, std::uint64_t *choices, std::size_t first, std::size_t last,
+                               float start = -std::numeric_limits<float>::infinity(),
+                               float entry = -std::numeric_limits<float>::infinity());
+    /**
+     * Parcours de l'étape retour dans un bloc de colonnes, de la case (cell_i, cell_j) jusqu'à sortir du bloc (ou
+     * atteindre la colonne 0). Les états et caractères sont ajoutés à la fin des chaînes, à l'envers.
+     * @param rows la table des lignes
+     * @param sequence la séquence
+     * @param choices les choix des colonnes start + 1 à start + block, words mots par colonne
+     * @param words le nombre de mots de choix par colonne
+     * @param start la colonne sauvegardée précédant le bloc
+     * @param cell_i la ligne de la case courante, mise à jour
+     * @param cell_j la colonne de la case courante, mise à jour
+     * @param aligned_sequence la séquence alignée, complétée
+     * @param states_sequence la séquence d'états, complétée
+     */
+    static void trace_block(const std::vector<ViterbiRow>& rows, const std::vector<char>& sequence,
+                            const std::uint64_t *choices, std::size_t words, std::size_t start, std::size_t& cell_i,
+                            std::size_t& cell_j, std::string& aligned_sequence, std::string& states_sequence);
+    /**
+     * Remplissage de la matrice de viterbi et étape retour. Si block < L, le remplissage ne garde qu'une colonne toutes
+     * les block colonnes, puis l'étape retour recalcule chaque bloc à partir de sa colonne sauvegardée, en partant de
+     * la fin : la mémoire est bornée, pour le prix d'un second remplissage.
+     * @param sequence la séquence
+     * @param residues la séquence digitalisée (sans gap)
+     * @param block le nombre de colonnes par bloc (L ou plus : un seul bloc, pas de second remplissage)
+     * @param band la bande à calculer (de largeur N : la matrice entière)
+     * @return le score de viterbi (dans la bande), la séquence alignée et la séquence d'états
+     */
+    [[nodiscard]] std::tuple<float, std::string, std::string> viterbi_traceback(
+            const std::vector<char>& sequence, const std::vector<std::uint8_t>& residues, std::size_t block,
+            const ViterbiBand& band) const;
+    /**
+     * Score de viterbi dans la bande seulement, en mémoire linéaire
+     * @param residues la séquence digitalisée (sans gap), non vide
+     * @param band la bande
+     * @param touched reçoit vrai si le meilleur chemin de la bande passe par son bord (ou s'il n'y en a pas) : le
+     * score peut alors différer de celui de la matrice entière
+     * @return V[3N][L] calculé dans la bande
+     */
+    [[nodiscard]] float banded_score(const std::vector<std::uint8_t>& residues, const ViterbiBand& band,
+                                     bool& touched) const;
+    /**
+     * Score de viterbi global sur la matrice entière, sans passer par la bande : moteur entier (option integer), puis
+     * vectorisé s'il est disponible, sinon scalaire
+     * @param residues la séquence digitalisée, sans gap
+     * @param integer vrai pour tenter d'abord le moteur sur entiers 16 bits
+     * @return le log de la probabilité de la séquence
+     */
+    [[nodiscard]] float full_score(const std::vector<std::uint8_t>& residues, bool integer) const;
+    /**
+     * Viterbi local ou glocal (voir Mode), sur la matrice complète. Autour du modèle, des états de flanc émettent selon
+     * le modèle nul : avant le premier domaine (N), entre deux domaines (J, option multiple) et après le dernier (C).
+     * B[j] est le meilleur chemin qui commence un domaine après j acides aminés (depuis N ou J). En mode glocal, c'est
+     * la valeur de l'état M0 de la colonne j ; en mode local, un domaine commence par une entrée directe dans un état
+     * M_k depuis B, qui coûte log(2 / (M (M + 1))) (M = N - 1 états M, comme HMMER), et tout état M_k peut sortir vers
+     * la fin du domaine. Avec l'option multiple, la fin d'un domaine mène à C ou J avec une
+     * probabilité 1/2 chacun.
+     * @param sequence la séquence, sans gap (ignorée sans hits)
+     * @param residues la séquence digitalisée
+     * @param options options de l'alignement (mode et multiple)
+     * @param hits si non nul, reçoit les domaines du meilleur chemin, dans l'ordre de la séquence (étape retour)
+     * @return le log-odds du meilleur chemin, -inf s'il n'y en a pas
+     */
+    float local_viterbi(const std::vector<char>& sequence, const std::vector<std::uint8_t>& residues,
+                        const AlignOptions& options, std::vector<Alignment> *hits) const;
+    /**
+     * Score de viterbi seul, en mémoire linéaire (implémentation scalaire, sans matrice retour)
+     * @param residues la séquence digitalisée (sans gap)
+     * @return V[3N][L]
+     */
+    [[nodiscard]] float viterbi_score(const std::vector<std::uint8_t>& residues) const;
+    /**
+     * Colonne j de la matrice Forward à partir de la précédente : mêmes lignes que viterbi, la somme (LogSum)
+     * remplaçant le maximum
+     * @param previous la colonne j-1
+     * @param current la colonne j, à remplir
+     * @param residue le caractère j-1 de la séquence, digitalisé
+     */
+    void forward_column(const float *previous, float *current, std::uint8_t residue) const;
+    /**
+     * Colonne j de la matrice Backward à partir de la suivante : log de la probabilité d'émettre la fin de la séquence
+     * (caractères j à L-1) depuis chaque case de la colonne j, sans l'émission de la case elle-même
+     * @param next la colonne j+1 (ignorée si last)
+     * @param current la colonne j, à remplir
+     * @param residue le caractère j de la séquence, digitalisé (ignoré si last)
+     * @param last vrai pour la colonne L, où seul l'état final peut encore être atteint
+     */
+    void backward_column(const float *next, float *current, std::uint8_t residue, bool last) const;
+    /**
+     * Score Forward seul, en mémoire linéaire
+     * @param residues la séquence digitalisée (sans gap)
+     * @return F[3N][L], log de la probabilité de la séquence sur tous les chemins
+     */
+    [[nodiscard]] float forward_score(const std::vector<std::uint8_t>& residues) const;
+    /**
+     * Colonne j de la matrice d'exactitude : même parcours que viterbi_column, les transitions possibles valant 0, les
+     * autres -inf, et l'émission étant remplacée par le gain de la case
+     * @param rows la table des lignes (transitions 0 ou -inf)
+     * @param previous la colonne j-1
+     * @param current la colonne j, à remplir
+     * @param gain le gain de chaque case de la colonne j : la probabilité postérieure pour M et I, 0 pour D et l'état
+     * final, -inf pour une case par laquelle aucun chemin ne passe
+     * @param choices reçoit les choix de l'étape retour, comme pour viterbi_column
+     */
+    static void accuracy_column(const std::vector<ViterbiRow>& rows, const float *previous, float *current,
+                                const float *gain, std::uint64_t *choices);
+    /**
+     * Décodage postérieur : Forward (matrice complète), Backward (colonne par colonne) puis chemin maximisant la somme
+     * des probabilités postérieures des caractères alignés (alignement d'exactitude maximale)
+     * @param sequence la séquence
+     * @param residues la séquence digitalisée (sans gap)
+     * @return le score Forward, la séquence alignée et la séquence d'états
+     */
+    [[nodiscard]] std::tuple<float, std::string, std::string> posterior_traceback(
+            const std::vector<char>& sequence, const std::vector<std::uint8_t>& residues) const;
     /**
      * Écriture de matrice contenant peut-être des flottants
+     * @param out le flux de sortie
      * @param matrix la matrice à écrire
      */
-    static void display_matrix(std::vector<std::vector<std::optional<float>>> matrix);
+    template <std::size_t Columns>
+    static void display_matrix(Output& out, const Matrix<Columns>& matrix);
     /**
-     * Surcharge pour une matrice de paire d'enter
-     * @param matrix
+     * Calcul des coordonnées d'un alignement d'après sa séquence d'états
+     * @param alignment l'alignement, dont les coordonnées sont remplies
      */
-    [[ maybe_unused ]] static void display_matrix(std::vector<std::vector<std::pair<int, int>>> matrix);
+    static void set_coordinates(Alignment& alignment);
     // VARIABLES DE CLASSE
-    // Liste de séquences
-    std::vector<std::vector<char>> sequences_;
     // Liste de colonnes marquées
     std::vector<bool> marked_columns_;
     // Matrice de probabilités de transition de chaque état vers les suivants à chaque rang de la HMM
-    std::vector<std::vector<std::optional<float>>> T_;
+    Profile::Transitions T_;
     // Matrice de probabilités d'émission de caractère en état M à chaque rang de la HMM
-    std::vector<std::vector<std::optional<float>>> e_M_;
+    Profile::Emissions e_M_;
     // Matrice de probabilités d'émission de caractère en état I à chaque rang de la HMM
-    std::vector<std::vector<std::optional<float>>> e_I_;
+    Profile::Emissions e_I_;
+    // Profil compilé (logarithmes) utilisé par viterbi, construit au chargement d'un fichier .model
+    Profile profile_;
+    // Moteur vectorisé pour le calcul du score seul, construit à partir du profil
+    Striped striped_;
+    // Même moteur sur entiers 16 bits (option integer)
+    Striped16 striped16_;
+    // Préfiltre SSV, construit à partir du profil
+    Ssv ssv_;
     // Nombre d'états de la HMM
     long N_{};
+    // Nom du modèle, lu dans une bibliothèque
+    std::string name_;
 };
 
 
@@ -0,0 +1,50 @@
+#ifndef PROJET_BIOINFO_WIRTH_LOGSUM_H
+#define PROJET_BIOINFO_WIRTH_LOGSUM_H
+
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+/**
+ * Somme de probabilités en espace logarithmique : log(exp(a) + exp(b)) = max + log(1 + exp(min - max)).
+ * Le second terme est lu dans une table précalculée (pas de 1 / scale), plutôt que calculé par exp et log1p : l'erreur
+ * est inférieure à 1e-3 par addition, sans effet sur les scores écrits avec 3 décimales par HMM-align.
+ * Au delà de size / scale, exp(min - max) est négligeable devant 1 : le maximum est retourné.
+ */
+struct LogSum {
+    static constexpr float scale = 1000;
+    static constexpr std::size_t size = 16000;
+
+    /**
+     * @param a log d'une probabilité (éventuellement -inf)
+     * @param b log d'une probabilité (éventuellement -inf)
+     * @return log(exp(a) + exp(b))
+     */
+    static float add(float a, float b) {
+        const float max = std::max(a, b);
+        const float min = std::min(a, b);
+        if (min == -1 * std::numeric_limits<float>::infinity() || max - min >= size / scale) {
+            return max;
+        }
+        return max + table[static_cast<std::size_t>((max - min) * scale + 0.5f)];
+    }
+
+    static float add(float a, float b, float c) {
+        return add(add(a, b), c);
+    }
+
+private:
+    // table[x] = log(1 + exp(-x / scale))
+    static inline const std::array<float, size + 1> table = [] {
+        std::array<float, size + 1> values{};
+        for (std::size_t x = 0; x <= size; x++) {
+            values[x] = static_cast<float>(std::log1p(std::exp(-static_cast<double>(x) / scale)));
+        }
+        return values;
+    }();
+};
+
+
+#endif //PROJET_BIOINFO_WIRTH_LOGSUM_H
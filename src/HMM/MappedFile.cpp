@@ -0,0 +1,65 @@
+#include <cerrno>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "MappedFile.h"
+#include "Stats.h"
+
+MappedFile::MappedFile(const std::string& filename) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("cannot open " + filename);
+    }
+    struct stat status{};
+    if (fstat(fd, &status) != 0) {
+        close(fd);
+        throw std::runtime_error("cannot stat " + filename);
+    }
+    // Tube, FIFO ou périphérique : la taille n'est pas connue d'avance, le contenu est lu jusqu'à la fin
+    if (not S_ISREG(status.st_mode)) {
+        buffer_.resize(65536);
+        while (true) {
+            if (size_ == buffer_.size()) {
+                buffer_.resize(2 * buffer_.size());
+            }
+            const ssize_t count = read(fd, buffer_.data() + size_, buffer_.size() - size_);
+            if (count < 0 && errno == EINTR) {
+                continue;
+            }
+            if (count < 0) {
+                close(fd);
+                throw std::runtime_error("cannot read " + filename);
+            }
+            if (count == 0) {
+                break;
+            }
+            size_ += static_cast<std::size_t>(count);
+        }
+        buffer_.resize(size_);
+        data_ = buffer_.data();
+        close(fd);
+        Stats::add(Stats::Counter::bytes_read, size_);
+        return;
+    }
+    size_ = static_cast<std::size_t>(status.st_size);
+    // Un fichier vide ne peut pas être projeté : il reste sans données
+    if (size_ != 0) {
+        void *address = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error("cannot map " + filename);
+        }
+        data_ = static_cast<const char *>(address);
+        mapped_ = true;
+    }
+    close(fd);
+    Stats::add(Stats::Counter::bytes_read, size_);
+}
+
+MappedFile::~MappedFile() {
+    if (mapped_) {
+        munmap(const_cast<char *>(data_), size_);
+    }
+}
@@ -0,0 +1,37 @@
+#ifndef PROJET_BIOINFO_WIRTH_MAPPEDFILE_H
+#define PROJET_BIOINFO_WIRTH_MAPPEDFILE_H
+
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * Fichier projeté en mémoire (mmap), en lecture seule. Le contenu reste accessible tant que l'objet existe.
+ * Un fichier qui n'est pas un fichier régulier (tube, FIFO, /dev/stdin) ne peut pas être projeté : il est lu en entier
+ * dans un tampon appartenant à l'objet.
+ */
+class MappedFile {
+public:
+    /**
+     * @param filename le fichier à projeter
+     * @throws std::runtime_error si le fichier ne peut pas être ouvert, lu ou projeté
+     */
+    explicit MappedFile(const std::string& filename);
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    [[nodiscard]] const char *data() const { return data_; }
+    [[nodiscard]] std::size_t size() const { return size_; }
+
+private:
+    const char *data_{};
+    std::size_t size_{};
+    // Contenu lu d'un fichier non régulier (data_ pointe alors dedans)
+    std::vector<char> buffer_;
+    bool mapped_ = false;
+};
+
+
+#endif //PROJET_BIOINFO_WIRTH_MAPPEDFILE_H
@@ -0,0 +1,86 @@
+#ifndef PROJET_BIOINFO_WIRTH_MATRIX_H
+#define PROJET_BIOINFO_WIRTH_MATRIX_H
+
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <vector>
+
+/**
+ * Matrice de flottants dense, rangée ligne par ligne dans un seul tableau aligné sur 64 octets, avec un nombre de
+ * colonnes fixé à la compilation (9 transitions, 20 émissions).
+ * Une case sans valeur (par exemple la première ligne de e_M, l'état M0 n'émettant pas) contient NaN.
+ * @tparam Columns nombre de colonnes
+ */
+template <std::size_t Columns>
+class Matrix {
+public:
+    static constexpr std::size_t columns = Columns;
+    // Valeur d'une case sans valeur
+    static constexpr float none = std::numeric_limits<float>::quiet_NaN();
+
+    Matrix() = default;
+
+    /**
+     * @param rows nombre de lignes
+     * @param value valeur initiale de toutes les cases
+     */
+    Matrix(std::size_t rows, float value)
+    :rows_(rows),
+    values_(rows * Columns, value)
+    {
+    }
+
+    // Nombre de lignes
+    [[nodiscard]] std::size_t rows() const { return rows_; }
+    // Nombre de cases
+    [[nodiscard]] std::size_t size() const { return values_.size(); }
+    // Début de la ligne row : la case (row, column) est matrix[row][column]
+    float *operator[](std::size_t row) { return values_.data() + row * Columns; }
+    const float *operator[](std::size_t row) const { return values_.data() + row * Columns; }
+    // Toutes les cases, ligne par ligne
+    float *data() { return values_.data(); }
+    [[nodiscard]] const float *data() const { return values_.data(); }
+
+    // Vrai si la case a une valeur (n'est pas NaN)
+    [[nodiscard]] bool has_value(std::size_t row, std::size_t column) const {
+        return not std::isnan((*this)[row][column]);
+    }
+
+    // Remplit la ligne row avec value
+    void fill_row(std::size_t row, float value) {
+        std::fill_n((*this)[row], Columns, value);
+    }
+
+private:
+    /**
+     * Allocation alignée sur une ligne de cache, pour les chargements vectoriels
+     */
+    template <class T>
+    struct AlignedAllocator {
+        using value_type = T;
+        static constexpr std::align_val_t alignment{64};
+
+        AlignedAllocator() = default;
+        template <class U>
+        AlignedAllocator(const AlignedAllocator<U>&) {}
+
+        T *allocate(std::size_t count) {
+            return static_cast<T *>(::operator new(count * sizeof(T), alignment));
+        }
+        void deallocate(T *pointer, std::size_t) {
+            ::operator delete(pointer, alignment);
+        }
+        bool operator==(const AlignedAllocator&) const { return true; }
+        bool operator!=(const AlignedAllocator&) const { return false; }
+    };
+
+    std::size_t rows_{};
+    std::vector<float, AlignedAllocator<float>> values_;
+};
+
+
+#endif //PROJET_BIOINFO_WIRTH_MATRIX_H
@@ -0,0 +1,83 @@
+#include <cmath>
+#include "Output.h"
+#include "Stats.h"
+
+std::optional<Output::Format> Output::parse_format(std::string_view name) {
+    if (name == "text") {
+        return Format::text;
+    }
+    if (name == "tsv") {
+        return Format::tsv;
+    }
+    if (name == "json") {
+        return Format::json;
+    }
+    return std::nullopt;
+}
+
+Output::Output(std::ostream& out)
+:out_(&out)
+{
+    buffer_.reserve(block_size + block_size / 4);
+}
+
+Output::~Output() {
+    flush();
+}
+
+Output& Output::operator<<(std::string_view text) {
+    buffer_.append(text);
+    if (out_ != nullptr && buffer_.size() >= block_size) {
+        flush();
+    }
+    return *this;
+}
+
+Output& Output::operator<<(char c) {
+    buffer_.push_back(c);
+    if (out_ != nullptr && buffer_.size() >= block_size) {
+        flush();
+    }
+    return *this;
+}
+
+Output& Output::operator<<(double value) {
+    // Le plus grand float s'écrit avec 39 chiffres avant la virgule
+    char text[512];
+    const auto result = std::to_chars(text, text + sizeof(text), value, std::chars_format::fixed, precision_);
+    return *this << std::string_view(text, static_cast<std::size_t>(result.ptr - text));
+}
+
+Output& Output::json(std::string_view text) {
+    static constexpr char hex[] = "0123456789abcdef";
+    buffer_.push_back('"');
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            buffer_.push_back('\\');
+            buffer_.push_back(c);
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            buffer_.append("\\u00");
+            buffer_.push_back(hex[(c >> 4) & 0xf]);
+            buffer_.push_back(hex[c & 0xf]);
+        } else {
+            buffer_.push_back(c);
+        }
+    }
+    return *this << '"';
+}
+
+Output& Output::json(double value) {
+    if (not std::isfinite(value)) {
+        return *this << "null";
+    }
+    return *this << value;
+}
+
+void Output::flush() {
+    if (out_ != nullptr && not buffer_.empty()) {
+        Stats::Timer timer(Stats::Stage::output);
+        out_->write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+        out_->flush();
+        buffer_.clear();
+    }
+}
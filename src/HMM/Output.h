@@ -0,0 +1,90 @@
+#ifndef PROJET_BIOINFO_WIRTH_OUTPUT_H
+#define PROJET_BIOINFO_WIRTH_OUTPUT_H
+
+
+#include <charconv>
+#include <cstddef>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+/**
+ * Écriture tamponnée : le texte est formaté dans un grand tampon, vidé dans le flux par blocs (et non à chaque ligne
+ * comme avec std::endl). Les flottants sont formatés par std::to_chars avec 3 décimales par défaut, comme
+ * std::fixed << std::setprecision(3) : les fichiers .model et les scores écrits sont identiques octet pour octet.
+ * Sans flux, le texte reste en mémoire (voir str).
+ */
+class Output {
+public:
+    // Format des résultats par séquence : texte (celui de HMM-align), ou une ligne par séquence, en colonnes séparées
+    // par des tabulations (tsv) ou en objet JSON (json)
+    enum class Format {
+        text,
+        tsv,
+        json
+    };
+    /**
+     * @param name "text", "tsv" ou "json"
+     * @return le format correspondant, sans valeur si le nom est inconnu
+     */
+    static std::optional<Format> parse_format(std::string_view name);
+    // Le tampon est vidé dans le flux dès qu'il dépasse cette taille
+    static constexpr std::size_t block_size = 1 << 20;
+
+    /**
+     * Texte gardé en mémoire
+     */
+    Output() = default;
+
+    /**
+     * @param out le flux de sortie, écrit par blocs
+     */
+    explicit Output(std::ostream& out);
+    Output(const Output&) = delete;
+    Output& operator=(const Output&) = delete;
+    // Vide le tampon dans le flux
+    ~Output();
+
+    Output& operator<<(std::string_view text);
+    Output& operator<<(char c);
+    // Flottants : notation décimale, precision() décimales
+    Output& operator<<(float value) { return *this << static_cast<double>(value); }
+    Output& operator<<(double value);
+
+    template <class Integer, std::enable_if_t<std::is_integral_v<Integer> && not std::is_same_v<Integer, char> &&
+                                              not std::is_same_v<Integer, bool>, int> = 0>
+    Output& operator<<(Integer value) {
+        char text[24];
+        const auto result = std::to_chars(text, text + sizeof(text), value);
+        return *this << std::string_view(text, static_cast<std::size_t>(result.ptr - text));
+    }
+
+    /**
+     * Chaîne JSON : text entre guillemets, les guillemets, barres obliques inverses et caractères de contrôle échappés
+     */
+    Output& json(std::string_view text);
+    /**
+     * Nombre JSON : value avec precision() décimales, ou null s'il n'est pas fini (JSON n'a ni inf ni NaN)
+     */
+    Output& json(double value);
+
+    // Nombre de décimales des flottants (3 par défaut)
+    void precision(int digits) { precision_ = digits; }
+    [[nodiscard]] int precision() const { return precision_; }
+
+    // Texte écrit depuis le dernier vidage (tout le texte, sans flux)
+    [[nodiscard]] const std::string& str() const { return buffer_; }
+
+    // Écrit le tampon dans le flux et le vide (sans effet sans flux)
+    void flush();
+
+private:
+    std::ostream *out_{};
+    std::string buffer_;
+    int precision_ = 3;
+};
+
+
+#endif //PROJET_BIOINFO_WIRTH_OUTPUT_H
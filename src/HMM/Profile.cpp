@@ -0,0 +1,53 @@
+#include <cmath>
+#include <limits>
+#include <vector>
+#include "Profile.h"
+
+Profile::Profile(const Transitions& T, const Emissions& e_M, const Emissions& e_I)
+:size_(T.rows())
+{
+    // Un seul tableau : transitions, puis émissions M, puis émissions I
+    auto values = std::make_shared<std::vector<float>>(size_ * (transitions + 2 * stride),
+                                                       -1 * std::numeric_limits<float>::infinity());
+    float *transition_values = values->data();
+    float *match_values = transition_values + size_ * transitions;
+    float *insert_values = match_values + size_ * stride;
+    // log(moyenne des probabilités des acides aminés représentés par code + epsilon)
+    auto emission = [](const float *line, std::uint8_t code) {
+        float sum = 0;
+        const auto members = Alphabet::members(code);
+        for (auto member : members) {
+            sum += line[member];
+        }
+        return logf(sum / static_cast<float>(members.size()) + epsilon);
+    };
+    for (std::size_t k = 0; k < size_; k++) {
+        for (std::size_t t = 0; t < transitions; t++) {
+            transition_values[k * transitions + t] = logf(T[k][t]);
+        }
+        for (std::uint8_t code = 0; code < Alphabet::codes; code++) {
+            if (code == Alphabet::gap) {
+                continue;
+            }
+            // La première ligne de e_M n'a pas de valeur : l'état M0 n'émet pas
+            if (e_M.has_value(k, 0)) {
+                match_values[k * stride + code] = emission(e_M[k], code);
+            }
+            insert_values[k * stride + code] = emission(e_I[k], code);
+        }
+    }
+    transitions_ = transition_values;
+    match_ = match_values;
+    insert_ = insert_values;
+    storage_ = std::move(values);
+}
+
+Profile::Profile(std::size_t size, const float *transitions, const float *match, const float *insert,
+                 std::shared_ptr<const void> storage)
+:size_(size),
+transitions_(transitions),
+match_(match),
+insert_(insert),
+storage_(std::move(storage))
+{
+}
@@ -0,0 +1,71 @@
+#ifndef PROJET_BIOINFO_WIRTH_PROFILE_H
+#define PROJET_BIOINFO_WIRTH_PROFILE_H
+
+
+#include <cstddef>
+#include <memory>
+#include "Alphabet.h"
+#include "Matrix.h"
+
+/**
+ * Profil compilé d'un modèle : logarithmes des transitions et des émissions, calculés une seule fois au chargement.
+ * Les valeurs sont rangées par rang du modèle dans des tableaux contigus, de sorte que l'algorithme de viterbi ne
+ * fasse plus aucun appel à logf ni recherche dans l'alphabet.
+ * Un code ambigu (B, Z, J, U, O, X) émet avec la moyenne des probabilités des acides aminés qu'il représente ; le code
+ * gap n'émet pas (-inf).
+ * Les tableaux appartiennent au profil, ou à une zone mémoire externe (fichier binaire projeté) que le profil garde en
+ * vie : les copies d'un profil partagent les mêmes tableaux.
+ */
+class Profile {
+public:
+    // Nombre de transitions par rang (M, D, I vers M, D, I)
+    static constexpr std::size_t transitions = 9;
+    // Nombre de caractères de l'alphabet (colonnes des matrices d'émission)
+    static constexpr std::size_t alphabet_size = Alphabet::size;
+    // Nombre de valeurs par rang dans les tableaux d'émission : un par code de l'alphabet (acides aminés et codes
+    // ambigus), complété jusqu'à 32
+    static constexpr std::size_t stride = 32;
+    // Ajouté aux probabilités d'émission avant le logarithme, pour éviter log(0)
+    static constexpr float epsilon = 1e-20;
+    // Matrices de probabilités de la HMM : une ligne par rang du modèle
+    using Transitions = Matrix<transitions>;
+    using Emissions = Matrix<alphabet_size>;
+
+    Profile() = default;
+
+    /**
+     * Compilation à partir des matrices de probabilités de la HMM
+     * @param T matrice des probabilités de transition
+     * @param e_M matrice des probabilités d'émission en état M (première ligne sans valeur)
+     * @param e_I matrice des probabilités d'émission en état I
+     */
+    Profile(const Transitions& T, const Emissions& e_M, const Emissions& e_I);
+
+    /**
+     * Profil déjà compilé, lu directement dans une zone mémoire externe (sans copie)
+     * @param size nombre de rangs du modèle
+     * @param transitions, match, insert les trois tableaux, dans la disposition décrite ci-dessous
+     * @param storage propriétaire de la zone mémoire, gardé en vie par le profil
+     */
+    Profile(std::size_t size, const float *transitions, const float *match, const float *insert,
+            std::shared_ptr<const void> storage);
+
+    // Nombre de rangs du modèle (N)
+    [[nodiscard]] std::size_t size() const { return size_; }
+    // log(T[k][.]), 9 valeurs
+    [[nodiscard]] const float *transition(std::size_t k) const { return transitions_ + k * transitions; }
+    // log(e_M[k][.] + epsilon), indicé par code de l'alphabet (-inf pour k = 0)
+    [[nodiscard]] const float *match(std::size_t k) const { return match_ + k * stride; }
+    // log(e_I[k][.] + epsilon), indicé par code de l'alphabet
+    [[nodiscard]] const float *insert(std::size_t k) const { return insert_ + k * stride; }
+
+private:
+    std::size_t size_{};
+    const float *transitions_{};
+    const float *match_{};
+    const float *insert_{};
+    std::shared_ptr<const void> storage_;
+};
+
+
+#endif //PROJET_BIOINFO_WIRTH_PROFILE_H
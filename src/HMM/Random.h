@@ -0,0 +1,69 @@
+#ifndef PROJET_BIOINFO_WIRTH_RANDOM_H
+#define PROJET_BIOINFO_WIRTH_RANDOM_H
+
+
+#include <cstdint>
+
+/**
+ * Générateur pseudo-aléatoire xoshiro256** (Blackman et Vigna) : 256 bits d'état, période 2^256 - 1.
+ * jump() avance de 2^128 tirages : des générateurs obtenus par sauts successifs à partir d'une même graine donnent des
+ * suites qui ne se recouvrent pas, et qui ne dépendent que de la graine et du nombre de sauts (flux reproductibles).
+ */
+class Random {
+public:
+    /**
+     * @param seed la graine, étendue aux 256 bits d'état par splitmix64
+     */
+    explicit Random(std::uint64_t seed) {
+        for (auto & word : state_) {
+            seed += 0x9e3779b97f4a7c15ULL;
+            std::uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            word = z ^ (z >> 31);
+        }
+    }
+
+    // 64 bits aléatoires
+    std::uint64_t next() {
+        const std::uint64_t result = rotate(state_[1] * 5, 7) * 9;
+        const std::uint64_t t = state_[1] << 17;
+        state_[2] ^= state_[0];
+        state_[3] ^= state_[1];
+        state_[1] ^= state_[2];
+        state_[0] ^= state_[3];
+        state_[2] ^= t;
+        state_[3] = rotate(state_[3], 45);
+        return result;
+    }
+
+    // Avance de 2^128 tirages
+    void jump() {
+        static constexpr std::uint64_t polynomial[] = {0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+                                                       0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL};
+        std::uint64_t jumped[4] = {0, 0, 0, 0};
+        for (std::uint64_t word : polynomial) {
+            for (int bit = 0; bit < 64; bit++) {
+                if (word & (1ULL << bit)) {
+                    for (int i = 0; i < 4; i++) {
+                        jumped[i] ^= state_[i];
+                    }
+                }
+                next();
+            }
+        }
+        for (int i = 0; i < 4; i++) {
+            state_[i] = jumped[i];
+        }
+    }
+
+private:
+    static std::uint64_t rotate(std::uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    std::uint64_t state_[4]{};
+};
+
+
+#endif //PROJET_BIOINFO_WIRTH_RANDOM_H
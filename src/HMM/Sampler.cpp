@@ -0,0 +1,141 @@
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include "Alphabet.h"
+#include "Output.h"
+#include "Sampler.h"
+#include "Stats.h"
+
+Sampler::Sampler(const Profile::Transitions& T, const Profile::Emissions& e_M, const Profile::Emissions& e_I)
+:size_(T.rows())
+{
+    for (std::size_t k = 0; k < size_; k++) {
+        for (std::size_t state = 0; state < 3; state++) {
+            transitions_.add(T[k] + 3 * state);
+        }
+        // La première ligne de e_M n'a pas de valeur (table jamais utilisée)
+        match_.add(e_M[k]);
+        insert_.add(e_I[k]);
+    }
+}
+
+// Méthode de Vose : les colonnes de probabilité inférieure à la moyenne sont complétées par une colonne supérieure
+void Sampler::AliasTables::add(const float *weights) {
+    std::vector<double> scaled(width, 0);
+    double sum = 0;
+    for (std::size_t i = 0; i < width; i++) {
+        if (weights[i] > 0) {
+            scaled[i] = weights[i];
+            sum += weights[i];
+        }
+    }
+    if (sum == 0) {
+        scaled.assign(width, 0);
+        scaled[0] = 1;
+        sum = 1;
+    }
+    std::vector<std::size_t> small;
+    std::vector<std::size_t> large;
+    for (std::size_t i = 0; i < width; i++) {
+        scaled[i] = scaled[i] * static_cast<double>(width) / sum;
+        (scaled[i] < 1 ? small : large).push_back(i);
+    }
+    const std::size_t offset = threshold.size();
+    threshold.resize(offset + width, 1);
+    alias.resize(offset + width);
+    for (std::size_t i = 0; i < width; i++) {
+        alias[offset + i] = static_cast<std::uint8_t>(i);
+    }
+    while (not small.empty() && not large.empty()) {
+        const std::size_t less = small.back();
+        const std::size_t more = large.back();
+        small.pop_back();
+        threshold[offset + less] = static_cast<float>(scaled[less]);
+        alias[offset + less] = static_cast<std::uint8_t>(more);
+        scaled[more] -= 1 - scaled[less];
+        if (scaled[more] < 1) {
+            large.pop_back();
+            small.push_back(more);
+        }
+    }
+    // Les colonnes restantes (erreurs d'arrondi) gardent un seuil de 1 : elles ne renvoient jamais à leur alias
+}
+
+// Parcours du modèle depuis l'état M0, jusqu'à atteindre le rang N (voir HMM::most_probable_sequence)
+void Sampler::sample(Random& random, std::string& sequence) const {
+    sequence.clear();
+    std::size_t k = 0;
+    std::size_t state = 0;
+    std::size_t insertions = 0;
+    while (true) {
+        std::size_t next = transitions_.draw(3 * k + state, random.next());
+        if (next == 2 && insertions == max_insertions) {
+            next = 0;
+        }
+        // Les états M et D passent au rang suivant, l'état I reste au même rang
+        if (next != 2) {
+            k++;
+            insertions = 0;
+            if (k == size_) {
+                return;
+            }
+        } else {
+            insertions++;
+        }
+        if (next == 0) {
+            sequence.push_back(Alphabet::residue(match_.draw(k, random.next())));
+        } else if (next == 2) {
+            sequence.push_back(Alphabet::residue(insert_.draw(k, random.next())));
+        }
+        state = next;
+    }
+}
+
+void Sampler::run(std::size_t count, std::uint64_t seed, unsigned threads, const std::string& name,
+                  std::ostream& stream) const {
+    threads = threads != 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+    const std::size_t batches = (count + batch_size - 1) / batch_size;
+    threads = static_cast<unsigned>(std::min<std::size_t>(threads, std::max<std::size_t>(batches, 1)));
+    // Générateur du prochain lot de chaque thread : celui de la graine avancé de (numéro du lot) sauts
+    std::vector<Random> streams;
+    Random base(seed);
+    for (unsigned thread = 0; thread < threads; thread++) {
+        streams.push_back(base);
+        base.jump();
+    }
+    Stats::add(Stats::Counter::sequences, count);
+    std::vector<std::string> texts(threads);
+    Output out(stream);
+    // Un lot par thread à chaque tour, écrits dans l'ordre des lots
+    for (std::size_t first = 0; first < batches; first += threads) {
+        auto worker = [&](unsigned thread) {
+            const std::size_t batch = first + thread;
+            texts[thread].clear();
+            if (batch >= batches) {
+                return;
+            }
+            Stats::Timer timer(Stats::Stage::sample);
+            Random random = streams[thread];
+            for (unsigned jump = 0; jump < threads; jump++) {
+                streams[thread].jump();
+            }
+            Output text;
+            std::string sequence;
+            for (std::size_t i = batch * batch_size; i < std::min(count, (batch + 1) * batch_size); i++) {
+                sample(random, sequence);
+                text << '>' << name << '_' << i + 1 << '\n' << sequence << '\n';
+            }
+            texts[thread] = text.str();
+        };
+        std::vector<std::thread> workers;
+        for (unsigned thread = 0; thread < threads; thread++) {
+            workers.emplace_back(worker, thread);
+        }
+        for (auto & thread : workers) {
+            thread.join();
+        }
+        for (const auto & text : texts) {
+            out << text;
+        }
+    }
+}
@@ -0,0 +1,86 @@
+#ifndef PROJET_BIOINFO_WIRTH_SAMPLER_H
+#define PROJET_BIOINFO_WIRTH_SAMPLER_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "Profile.h"
+#include "Random.h"
+
+/**
+ * Tirage aléatoire de séquences selon un modèle (HMM-genseq --sample) : le chemin d'états est tiré selon les
+ * probabilités de transition, et chaque état M ou I émet un acide aminé tiré selon ses probabilités d'émission.
+ * Chaque distribution (3 transitions par état et par rang, 20 émissions par état et par rang) est précalculée en table
+ * d'alias (Walker, Vose) : un tirage coûte un nombre aléatoire et une comparaison, quelle que soit la distribution.
+ * Les probabilités d'une ligne sont normalisées par leur somme (les modèles texte sont arrondis à 3 décimales) ; une
+ * ligne de somme nulle (état jamais atteint) donne toujours la première valeur.
+ */
+class Sampler {
+public:
+    // Nombre de séquences d'un lot : le lot b est tiré avec le générateur de la graine avancé de b sauts (voir Random),
+    // les séquences sont donc les mêmes quel que soit le nombre de threads
+    static constexpr std::size_t batch_size = 4096;
+    // Longueur maximale d'une suite d'insertions au même rang, au delà de laquelle l'état M est imposé (une probabilité
+    // I -> I arrondie à 1 ne termine jamais)
+    static constexpr std::size_t max_insertions = 10000;
+
+    /**
+     * @param T matrice des probabilités de transition
+     * @param e_M matrice des probabilités d'émission en état M (première ligne sans valeur)
+     * @param e_I matrice des probabilités d'émission en état I
+     */
+    Sampler(const Profile::Transitions& T, const Profile::Emissions& e_M, const Profile::Emissions& e_I);
+
+    /**
+     * Tirage d'une séquence (acides aminés uniquement, sans les états D)
+     * @param random le générateur
+     * @param sequence la séquence tirée, remplacée
+     */
+    void sample(Random& random, std::string& sequence) const;
+
+    /**
+     * Tirage de count séquences, écrites au format fasta ('>name_i', i à partir de 1, puis la séquence sur une ligne).
+     * Les lots sont répartis entre les threads et écrits dans l'ordre : le résultat ne dépend que de la graine.
+     * @param count le nombre de séquences
+     * @param seed la graine
+     * @param threads nombre de threads (0 : autant que de coeurs)
+     * @param name préfixe des en-têtes
+     * @param out le flux de sortie
+     */
+    void run(std::size_t count, std::uint64_t seed, unsigned threads, const std::string& name,
+             std::ostream& out) const;
+
+private:
+    /**
+     * Tables d'alias de distributions de même taille, rangées l'une après l'autre
+     */
+    struct AliasTables {
+        explicit AliasTables(std::size_t width): width(width) {}
+        // Ajout de la table de la distribution weights (width poids positifs, NaN comptés 0)
+        void add(const float *weights);
+        // Tirage dans la table table à partir de 64 bits aléatoires : les 32 bits de poids fort choisissent la colonne,
+        // les 32 autres la comparent à son seuil
+        [[nodiscard]] std::uint8_t draw(std::size_t table, std::uint64_t bits) const {
+            const std::size_t index = table * width + (((bits >> 32) * width) >> 32);
+            const float fraction = static_cast<float>(bits & 0xffffffffULL) * 0x1p-32f;
+            return fraction < threshold[index] ? static_cast<std::uint8_t>(index - table * width) : alias[index];
+        }
+
+        std::size_t width;
+        std::vector<float> threshold;
+        std::vector<std::uint8_t> alias;
+    };
+
+    std::size_t size_;
+    // Une table par rang et par état de départ (M, D, I), de 3 états d'arrivée
+    AliasTables transitions_{3};
+    // Une table par rang, de 20 acides aminés
+    AliasTables match_{Profile::alphabet_size};
+    AliasTables insert_{Profile::alphabet_size};
+};
+
+
+#endif //PROJET_BIOINFO_WIRTH_SAMPLER_H
@@ -0,0 +1,295 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Alphabet.h"
+#include "Search.h"
+#include "Stats.h"
+
+namespace {
+
+// Taille visée d'un paquet, en acides aminés, et nombre de paquets lus par thread pour former un bloc
+constexpr std::size_t chunk_residues = 16384;
+constexpr std::size_t chunks_per_thread = 8;
+
+// Paquet de séquences consécutives du bloc : les séquences first à last - 1
+struct Chunk {
+    std::size_t first;
+    std::size_t last;
+    std::size_t residues;
+};
+
+// Bloc de séquences : en-têtes et séquences digitalisées (les count premiers sont valides), paquets, et scores des
+// couples (séquence, modèle)
+struct Block {
+    std::vector<std::string> headers;
+    std::vector<std::vector<std::uint8_t>> sequences;
+    std::size_t count = 0;
+    std::vector<Chunk> chunks;
+    std::vector<float> scores;
+};
+
+// File de tâches d'un thread : il prend ses tâches au début, les autres volent à la fin
+struct TaskQueue {
+    std::mutex mutex;
+    std::deque<std::size_t> tasks;
+
+    bool pop_front(std::size_t& task) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (tasks.empty()) {
+            return false;
+        }
+        task = tasks.front();
+        tasks.pop_front();
+        return true;
+    }
+
+    bool pop_back(std::size_t& task) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (tasks.empty()) {
+            return false;
+        }
+        task = tasks.back();
+        tasks.pop_back();
+        return true;
+    }
+};
+
+}
+
+Search::Search(const std::vector<std::string>& models, unsigned threads)
+:threads_(threads != 0 ? threads : std::max(1u, std::thread::hardware_concurrency()))
+{
+    // Chaque fichier peut contenir plusieurs modèles (bibliothèque)
+    for (const auto & file : models) {
+        for (auto & model : HMM::load_library(file)) {
+            models_.push_back(std::move(model));
+        }
+    }
+}
+
+Search::Counts Search::run(const Fasta& fasta, const Options& options, std::ostream& stream) const {
+    HMM::check_options(options.align);
+    // Score d'un acide aminé sous le modèle nul
+    const double null_score = std::log(1.0 / Alphabet::size);
+    // Deux blocs : les threads calculent les scores de l'un pendant que le thread principal lit l'autre, puis écrit
+    // les résultats du premier. Les tampons sont réutilisés d'un bloc à l'autre.
+    Block blocks[2];
+    std::vector<std::size_t> tasks;
+    std::vector<TaskQueue> queues(threads_);
+    Output out(stream);
+    Counts counts;
+    std::atomic<std::size_t> passed{0};
+    // Bloc en cours de calcul, numéro de génération de ses tâches, et nombre de threads qui n'en ont pas fini
+    Block *current = nullptr;
+    std::size_t generation = 0;
+    unsigned pending = 0;
+    bool stop = false;
+    std::mutex mutex;
+    std::condition_variable cv;
+    // Première erreur d'un thread : les autres abandonnent le bloc, et elle est relancée après leur fin
+    std::exception_ptr failure;
+
+    auto record = fasta.begin();
+    // Lecture d'un bloc, paquet par paquet
+    auto parse = [&](Block& block) {
+        Stats::Timer timer(Stats::Stage::parse);
+        block.count = 0;
+        block.chunks.clear();
+        while (record != fasta.end() && block.chunks.size() < chunks_per_thread * threads_) {
+            Chunk chunk{block.count, block.count, 0};
+            while (record != fasta.end() && chunk.residues < chunk_residues) {
+                if (block.count == block.sequences.size()) {
+                    block.headers.emplace_back();
+                    block.sequences.emplace_back();
+                }
+                block.headers[block.count].assign(record->header);
+                auto & sequence = block.sequences[block.count];
+                sequence.clear();
+                record->digitize(sequence);
+                // Les gaps ne sont pas des acides aminés (voir HMM::align)
+                sequence.erase(std::remove(sequence.begin(), sequence.end(), Alphabet::gap), sequence.end());
+                chunk.residues += sequence.size();
+                ++record;
+                ++block.count;
+            }
+            chunk.last = block.count;
+            block.chunks.push_back(chunk);
+        }
+        Stats::add(Stats::Counter::sequences, block.count);
+    };
+
+    // Tâches (modèle, paquet), numérotées modèle * paquets + paquet, distribuées de la plus coûteuse à la moins
+    // coûteuse (coût : N x nombre d'acides aminés) entre les files des threads, puis confiées aux threads
+    auto publish = [&](Block& block) {
+        const auto & chunks = block.chunks;
+        tasks.resize(models_.size() * chunks.size());
+        std::iota(tasks.begin(), tasks.end(), 0);
+        auto cost = [&](std::size_t task) {
+            return models_[task / chunks.size()].size() * (chunks[task % chunks.size()].residues + 1);
+        };
+        std::stable_sort(tasks.begin(), tasks.end(), [&](std::size_t a, std::size_t b) { return cost(a) > cost(b); });
+        for (std::size_t i = 0; i < tasks.size(); i++) {
+            queues[i % threads_].tasks.push_back(tasks[i]);
+        }
+        block.scores.assign(block.count * models_.size(), 0);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            current = &block;
+            generation++;
+            pending = threads_;
+        }
+        cv.notify_all();
+    };
+
+    // Chaque thread vide sa file, puis vole les tâches restantes des autres : aucune tâche n'est créée en cours de
+    // route, un thread qui ne trouve plus rien a fini le bloc et attend le suivant
+    auto work = [&](std::size_t self) {
+        std::size_t seen = 0;
+        while (true) {
+            Block *block;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [&]() { return stop || generation != seen; });
+                if (stop) {
+                    return;
+                }
+                seen = generation;
+                block = current;
+            }
+            const auto & chunks = block->chunks;
+            std::size_t task;
+            while (true) {
+                bool found = queues[self].pop_front(task);
+                for (std::size_t other = 1; not found && other < threads_; other++) {
+                    found = queues[(self + other) % threads_].pop_back(task);
+                }
+                if (not found) {
+                    break;
+                }
+                const std::size_t model = task / chunks.size();
+                const auto & chunk = chunks[task % chunks.size()];
+                std::size_t chunk_passed = 0;
+                for (std::size_t i = chunk.first; i < chunk.last; i++) {
+                    float & score = block->scores[i * models_.size() + model];
+                    if (options.prefilter.has_value() &&
+                        models_[model].prefilter_score(block->sequences[i]) < options.prefilter.value()) {
+                        score = -1 * std::numeric_limits<float>::infinity();
+                        continue;
+                    }
+                    score = models_[model].score(block->sequences[i], options.align);
+                    chunk_passed++;
+                }
+                passed += chunk_passed;
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                pending--;
+            }
+            cv.notify_all();
+        }
+    };
+    auto worker = [&](std::size_t self) {
+        try {
+            work(self);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (not failure) {
+                failure = std::current_exception();
+            }
+            stop = true;
+            cv.notify_all();
+        }
+    };
+
+    // Écriture dans l'ordre des séquences, puis des modèles
+    auto write = [&](const Block& block) {
+        counts.pairs += block.count * models_.size();
+        for (std::size_t i = 0; i < block.count; i++) {
+            for (std::size_t model = 0; model < models_.size(); model++) {
+                const float score = block.scores[i * models_.size() + model];
+                // Hors du mode global, le score est déjà rapporté au modèle nul (flancs émis par le modèle nul)
+                const double odds = options.align.mode == HMM::Mode::global
+                                    ? score - static_cast<double>(block.sequences[i].size()) * null_score : score;
+                if (odds >= options.threshold) {
+                    counts.reported++;
+                    if (options.format == Output::Format::json) {
+                        out << "{\"model\":";
+                        out.json(models_[model].name());
+                        out << ",\"header\":";
+                        out.json(block.headers[i]);
+                        out << ",\"score\":";
+                        out.json(score);
+                        out << ",\"odds\":";
+                        out.json(odds);
+                        out << "}\n";
+                    } else {
+                        out << models_[model].name() << '\t' << block.headers[i] << '\t' << score << '\t' << odds
+                            << '\n';
+                    }
+                }
+            }
+        }
+    };
+
+    // Les threads sont lancés une fois pour toute la recherche
+    std::vector<std::thread> workers;
+    for (std::size_t i = 0; i < threads_; i++) {
+        workers.emplace_back(worker, i);
+    }
+    auto finish = [&]() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        cv.notify_all();
+        for (auto & thread : workers) {
+            thread.join();
+        }
+    };
+    try {
+        std::size_t index = 0;
+        parse(blocks[index]);
+        if (blocks[index].count != 0) {
+            publish(blocks[index]);
+        }
+        while (blocks[index].count != 0) {
+            // Le bloc suivant est lu pendant le calcul du bloc courant
+            Block & next = blocks[1 - index];
+            parse(next);
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [&]() { return failure || pending == 0; });
+                if (failure) {
+                    break;
+                }
+            }
+            // Puis le bloc courant est écrit pendant le calcul du suivant
+            if (next.count != 0) {
+                publish(next);
+            }
+            write(blocks[index]);
+            index = 1 - index;
+        }
+    } catch (...) {
+        finish();
+        throw;
+    }
+    finish();
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+    out.flush();
+    counts.prefilter = passed;
+    return counts;
+}
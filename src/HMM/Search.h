@@ -0,0 +1,80 @@
+#ifndef PROJET_BIOINFO_WIRTH_SEARCH_H
+#define PROJET_BIOINFO_WIRTH_SEARCH_H
+
+
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "Fasta.h"
+#include "HMM.h"
+#include "Output.h"
+
+/**
+ * Recherche d'une bibliothèque de modèles dans une base de séquences : chaque séquence est comparée à chaque modèle.
+ * Les modèles sont chargés une fois ; les séquences sont lues au fil de l'eau, par blocs, et découpées en paquets
+ * (chunks). Une tâche est un couple (modèle, paquet) : les tâches d'un bloc sont réparties entre les threads, chacun
+ * dans sa propre file, et un thread dont la file est vide vole les tâches des autres (work stealing), les modèles
+ * pouvant être de longueurs très différentes. Les threads sont lancés une fois : pendant qu'ils calculent un bloc, le
+ * thread principal lit le suivant, puis écrit les résultats du premier.
+ * Un préfiltre (SSV) peut écarter les couples sans ressemblance avant le calcul du score : les couples retenus ont
+ * exactement le score qu'ils auraient sans préfiltre.
+ */
+class Search {
+public:
+    /**
+     * Options de la recherche - HMM-search
+     */
+    struct Options {
+        // Options du calcul du score (viterbi ou Forward)
+        HMM::AlignOptions align;
+        // Seuil de report, sur le score rapporté au modèle nul (acides aminés équiprobables) : score - L log(1 / 20)
+        float threshold = 0;
+        // Seuil du préfiltre SSV, sur le même score rapporté au modèle nul (voir Ssv) : un couple en dessous est écarté
+        // sans calculer son score. Sans valeur, pas de préfiltre.
+        std::optional<float> prefilter;
+        // Format des lignes : colonnes séparées par des tabulations (text et tsv), ou objets JSON (json)
+        Output::Format format = Output::Format::text;
+    };
+
+    /**
+     * Nombre de couples (modèle, séquence) passés à chaque étape
+     */
+    struct Counts {
+        // Couples comparés
+        std::size_t pairs = 0;
+        // Couples retenus par le préfiltre (tous sans préfiltre), dont le score a été calculé
+        std::size_t prefilter = 0;
+        // Couples dont le score atteint le seuil, écrits
+        std::size_t reported = 0;
+    };
+
+    /**
+     * @param models les fichiers .model de la bibliothèque, chargés une fois ; chacun peut contenir plusieurs modèles
+     * @param threads nombre de threads de calcul (0 : autant que de coeurs)
+     * @throws std::runtime_error si un fichier ne peut pas être lu ou si un modèle est invalide
+     */
+    Search(const std::vector<std::string>& models, unsigned threads);
+
+    /**
+     * Compare chaque séquence à chaque modèle, et écrit une ligne par couple dont le score dépasse le seuil :
+     * nom du modèle, en-tête de la séquence, score et score rapporté au modèle nul, séparés par des tabulations (ou
+     * dans un objet JSON : model, header, score, odds). Hors du mode global, le score est déjà un log-odds : les deux
+     * valeurs sont égales.
+     * Les lignes sont écrites dans l'ordre du fichier de séquences puis de la bibliothèque, quel que soit le nombre de
+     * threads.
+     * @param fasta la base de séquences
+     * @param options options de la recherche
+     * @param out le flux de sortie, écrit par blocs
+     * @return le nombre de couples passés à chaque étape
+     */
+    Counts run(const Fasta& fasta, const Options& options, std::ostream& out) const;
+
+private:
+    // Modèles de la bibliothèque, nommés d'après leur fichier (voir HMM::load_library)
+    std::vector<HMM> models_;
+    unsigned threads_;
+};
+
+
+#endif //PROJET_BIOINFO_WIRTH_SEARCH_H
@@ -0,0 +1,273 @@
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "Output.h"
+#include "Server.h"
+
+namespace {
+
+// Champs d'une requête, séparés par des blancs
+std::vector<std::string_view> split(std::string_view request) {
+    std::vector<std::string_view> fields;
+    std::size_t position = 0;
+    while (position < request.size()) {
+        const std::size_t begin = request.find_first_not_of(" \t\r", position);
+        if (begin == std::string_view::npos) {
+            break;
+        }
+        const std::size_t end = std::min(request.find_first_of(" \t\r", begin), request.size());
+        fields.push_back(request.substr(begin, end - begin));
+        position = end;
+    }
+    return fields;
+}
+
+}
+
+Server::Channel::Channel(int in, int out)
+:in_(in),
+out_(out)
+{
+}
+
+bool Server::Channel::read_line(std::string& line) {
+    while (true) {
+        const std::size_t end = buffer_.find('\n', position_);
+        if (end != std::string::npos) {
+            line.assign(buffer_, position_, end - position_);
+            position_ = end + 1;
+            if (not line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            return true;
+        }
+        // Ligne incomplète : la partie lue est ramenée au début du tampon, puis complétée
+        buffer_.erase(0, position_);
+        position_ = 0;
+        char block[65536];
+        const ssize_t count = ::read(in_, block, sizeof(block));
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            // Dernière ligne sans '\n'
+            if (count == 0 && not buffer_.empty()) {
+                line = std::move(buffer_);
+                buffer_.clear();
+                return true;
+            }
+            return false;
+        }
+        buffer_.append(block, static_cast<std::size_t>(count));
+    }
+}
+
+bool Server::Channel::write(std::string_view text) {
+    while (not text.empty()) {
+        const ssize_t count = ::write(out_, text.data(), text.size());
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            return false;
+        }
+        text.remove_prefix(static_cast<std::size_t>(count));
+    }
+    return true;
+}
+
+Server::Server(const std::vector<std::string>& model_files, unsigned threads)
+:threads_(threads != 0 ? threads : std::max(1u, std::thread::hardware_concurrency()))
+{
+    for (const auto & file : model_files) {
+        for (auto & model : HMM::load_library(file)) {
+            if (not names_.emplace(model.name(), models_.size()).second) {
+                throw std::runtime_error("duplicate model name " + model.name());
+            }
+            models_.push_back(std::move(model));
+        }
+    }
+}
+
+std::string Server::answer(std::string_view request) const {
+    const std::vector<std::string_view> fields = split(request);
+    Output out;
+    auto fail = [&out](std::string_view message) {
+        out << "error\t" << message << '\n';
+        return out.str();
+    };
+    if (fields.empty()) {
+        return fail("empty request");
+    }
+    const std::string_view command = fields[0];
+    if (command == "quit") {
+        return {};
+    }
+    if (command == "models") {
+        out << "ok";
+        for (const auto & model : models_) {
+            out << '\t' << model.name();
+        }
+        out << '\n';
+        return out.str();
+    }
+    if (command != "align" && command != "score") {
+        return fail("unknown command " + std::string(command));
+    }
+    HMM::AlignOptions options;
+    options.score = command == "score";
+    std::size_t i = 1;
+    for (; i < fields.size() && fields[i].substr(0, 2) == "--"; i++) {
+        if (fields[i] == "--posterior") {
+            options.posterior = true;
+        } else if (fields[i] == "--local") {
+            options.mode = HMM::Mode::local;
+        } else if (fields[i] == "--glocal") {
+            options.mode = HMM::Mode::glocal;
+        } else if (fields[i] == "--multiple") {
+            options.multiple = true;
+        } else if (fields[i] == "--integer") {
+            options.integer = true;
+        } else if (fields[i] == "--band" && i + 1 < fields.size()) {
+            const std::string_view width = fields[++i];
+            const auto result = std::from_chars(width.data(), width.data() + width.size(), options.band);
+            if (result.ec != std::errc() || result.ptr != width.data() + width.size()) {
+                return fail("invalid band width " + std::string(width));
+            }
+        } else {
+            return fail("unknown option " + std::string(fields[i]));
+        }
+    }
+    if (fields.size() - i != 2) {
+        return fail("expected a model and a sequence");
+    }
+    std::size_t model = 0;
+    if (fields[i] != "-" || models_.size() != 1) {
+        const auto found = names_.find(std::string(fields[i]));
+        if (found == names_.end()) {
+            return fail("unknown model " + std::string(fields[i]));
+        }
+        model = found->second;
+    }
+    const std::vector<char> sequence(fields[i + 1].begin(), fields[i + 1].end());
+    std::vector<HMM::Alignment> hits;
+    try {
+        hits = models_[model].align_hits(sequence, options);
+    } catch (const std::exception& e) {
+        return fail(e.what());
+    }
+    out << "ok";
+    for (const auto & alignment : hits) {
+        out << '\t' << alignment.score;
+        if (not options.score) {
+            out << '\t' << alignment.sequence << '\t' << alignment.states << '\t' << alignment.sequence_begin << '\t'
+                << alignment.sequence_end << '\t' << alignment.model_begin << '\t' << alignment.model_end;
+        }
+    }
+    out << '\n';
+    return out.str();
+}
+
+void Server::serve(Channel& channel) const {
+    std::string line;
+    while (channel.read_line(line)) {
+        const std::string response = answer(line);
+        if (response.empty() || not channel.write(response)) {
+            return;
+        }
+    }
+}
+
+void Server::listen(const std::string& socket_path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("socket path too long: " + socket_path);
+    }
+    std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size() + 1);
+    const int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        throw std::runtime_error("cannot create a socket");
+    }
+    unlink(socket_path.c_str());
+    if (bind(listener, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0 ||
+        ::listen(listener, SOMAXCONN) != 0) {
+        close(listener);
+        throw std::runtime_error("cannot listen on " + socket_path);
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        listener_ = listener;
+    }
+
+    // Chaque thread sert une connexion jusqu'à sa fin, puis prend la suivante
+    auto worker = [this]() {
+        while (true) {
+            int client;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [this]() { return stopped_ || not pending_.empty(); });
+                if (stopped_) {
+                    return;
+                }
+                client = pending_.front();
+                pending_.pop_front();
+                active_.push_back(client);
+            }
+            Channel channel(client, client);
+            serve(channel);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                active_.erase(std::find(active_.begin(), active_.end(), client));
+                close(client);
+            }
+        }
+    };
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < threads_; i++) {
+        workers.emplace_back(worker);
+    }
+    // stop ferme la socket d'écoute : accept échoue
+    while (not stopped_) {
+        const int client = accept(listener, nullptr, nullptr);
+        if (client < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            break;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_.push_back(client);
+        cv_.notify_one();
+    }
+    stop();
+    for (auto & thread : workers) {
+        thread.join();
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (int client : pending_) {
+        close(client);
+    }
+    pending_.clear();
+    listener_ = -1;
+    close(listener);
+    unlink(socket_path.c_str());
+}
+
+void Server::stop() {
+    stopped_ = true;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (listener_ >= 0) {
+        shutdown(listener_, SHUT_RDWR);
+    }
+    for (int client : active_) {
+        shutdown(client, SHUT_RDWR);
+    }
+    cv_.notify_all();
+}
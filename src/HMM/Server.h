@@ -0,0 +1,110 @@
+#ifndef PROJET_BIOINFO_WIRTH_SERVER_H
+#define PROJET_BIOINFO_WIRTH_SERVER_H
+
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "HMM.h"
+
+/**
+ * Serveur d'alignement (HMM-server) : les modèles sont chargés une fois, puis chaque requête ne coûte que son calcul.
+ * Protocole texte, une requête par ligne et une réponse par ligne :
+ *  - "align [options] modèle séquence" : "ok", score, séquence alignée, séquence d'états et coordonnées (voir
+ *    HMM::Alignment : sequence_begin, sequence_end, model_begin, model_end). Hors du mode global, ces 7 champs sont
+ *    répétés pour chaque domaine (voir HMM::align_hits), et "ok" seul s'il n'y en a aucun ;
+ *  - "score [options] modèle séquence" : "ok" et le score (celui de HMM-align --score) ;
+ *  - "models" : "ok" et les noms des modèles chargés ;
+ *  - "quit" : fin de la connexion, sans réponse.
+ * Les options sont celles de HMM-align : --posterior, --band W, --local, --glocal, --multiple et --integer.
+ * Les champs sont séparés par des espaces dans la requête, par des tabulations dans la réponse. Une requête invalide
+ * reçoit "error" et le message. Le modèle est désigné par son nom (voir HMM::load_library), ou par "-" s'il n'y en a
+ * qu'un.
+ * Les connexions (socket Unix) sont servies par un groupe de threads, une connexion à la fois par thread : un client
+ * garde sa connexion ouverte et enchaîne ses requêtes.
+ */
+class Server {
+public:
+    /**
+     * Lecture par lignes et écriture sur un descripteur de fichier (socket, entrée ou sortie standard)
+     */
+    class Channel {
+    public:
+        /**
+         * @param in le descripteur lu
+         * @param out le descripteur écrit (le même pour une socket)
+         */
+        Channel(int in, int out);
+        /**
+         * @param line la ligne suivante, sans le '\n' (ni '\r')
+         * @return faux à la fin du flux ou en cas d'erreur
+         */
+        bool read_line(std::string& line);
+        /**
+         * Écriture complète de text
+         * @return faux en cas d'erreur (client déconnecté)
+         */
+        bool write(std::string_view text);
+
+    private:
+        int in_;
+        int out_;
+        std::string buffer_;
+        // Début de la partie non lue de buffer_
+        std::size_t position_ = 0;
+    };
+
+    /**
+     * @param model_files les fichiers modèles (ou bibliothèques) à charger
+     * @param threads nombre de connexions servies à la fois (0 : autant que de coeurs)
+     * @throws std::runtime_error si un modèle ne peut pas être chargé, ou si deux modèles ont le même nom
+     */
+    Server(const std::vector<std::string>& model_files, unsigned threads);
+
+    /**
+     * Réponse à une requête
+     * @param request la ligne de requête, sans le '\n'
+     * @return la ligne de réponse, '\n' compris (vide pour "quit")
+     */
+    [[nodiscard]] std::string answer(std::string_view request) const;
+
+    /**
+     * Traitement des requêtes d'une connexion, jusqu'à sa fin ou "quit"
+     * @param channel la connexion
+     */
+    void serve(Channel& channel) const;
+
+    /**
+     * Écoute sur une socket Unix jusqu'à l'appel de stop : chaque connexion acceptée est confiée au groupe de threads.
+     * Un fichier existant au chemin de la socket est remplacé ; la socket est supprimée à la fin.
+     * @param socket_path le chemin de la socket
+     * @throws std::runtime_error si la socket ne peut pas être créée
+     */
+    void listen(const std::string& socket_path);
+
+    /**
+     * Arrêt de listen : plus aucune connexion n'est acceptée, et les connexions en cours sont fermées. Peut être appelé
+     * depuis un autre thread.
+     */
+    void stop();
+
+private:
+    std::vector<HMM> models_;
+    std::unordered_map<std::string, std::size_t> names_;
+    unsigned threads_;
+    std::atomic<bool> stopped_{false};
+    // Socket d'écoute, connexions en attente d'un thread et connexions en cours (fermées par stop), sous mutex_
+    std::mutex mutex_;
+    int listener_ = -1;
+    std::condition_variable cv_;
+    std::deque<int> pending_;
+    std::vector<int> active_;
+};
+
+
+#endif //PROJET_BIOINFO_WIRTH_SERVER_H
@@ -0,0 +1,80 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "Ssv.h"
+#include "SsvKernel.h"
+
+namespace {
+
+// Opérations "vectorielles" sur une seule voie, pour les machines sans SSE4.1
+struct Scalar {
+    using V = std::uint8_t;
+    static constexpr std::size_t width = 1;
+    static V load(const std::uint8_t *p) { return *p; }
+    static void store(std::uint8_t *p, V v) { *p = v; }
+    static V set1(std::uint8_t value) { return value; }
+    static V adds(V a, V b) { return static_cast<V>(std::min(255, a + b)); }
+    static V subs(V a, V b) { return static_cast<V>(a > b ? a - b : 0); }
+    static V max(V a, V b) { return std::max(a, b); }
+    static V shift(V) { return 0; }
+    static std::uint8_t hmax(V v) { return v; }
+};
+
+}
+
+Ssv::Ssv(const Profile& profile, Striped::Isa isa)
+:isa_(isa)
+{
+    const std::size_t size = profile.size();
+    if (size == 0) {
+        return;
+    }
+    width_ = isa_ == Striped::Isa::AVX2 ? 32 : isa_ == Striped::Isa::SSE41 ? 16 : 1;
+    segments_ = (size + width_ - 1) / width_;
+    // Scores arrondis des émissions, en unités de 1/3 de bit ; le biais est le plus grand d'entre eux
+    std::vector<int> scores(Alphabet::codes * segments_ * width_, std::numeric_limits<int>::min());
+    int bias = 0;
+    for (std::size_t k = 0; k < size; k++) {
+        std::size_t q = k % segments_;
+        std::size_t lane = k / segments_;
+        for (std::size_t a = 0; a < Alphabet::codes; a++) {
+            const float match = profile.match(k)[a];
+            if (std::isinf(match)) {
+                continue;
+            }
+            const int score = static_cast<int>(std::lround(scale * (match - std::log(background))));
+            scores[(a * segments_ + q) * width_ + lane] = std::max(score, -255);
+            bias = std::max(bias, score);
+        }
+    }
+    bias_ = static_cast<std::uint8_t>(std::min(bias, 255));
+    costs_.resize(scores.size());
+    for (std::size_t index = 0; index < scores.size(); index++) {
+        costs_[index] = scores[index] == std::numeric_limits<int>::min()
+                ? 255 : static_cast<std::uint8_t>(std::clamp(bias_ - scores[index], 0, 255));
+    }
+}
+
+float Ssv::score(const std::vector<std::uint8_t>& residues) const {
+    if (segments_ == 0) {
+        return 0;
+    }
+    std::vector<std::uint8_t> work(segments_ * width_);
+    Layout layout{segments_, costs_.data(), bias_};
+    std::uint8_t best;
+    switch (isa_) {
+        case Striped::Isa::AVX2:
+            best = ssv_avx2(layout, residues.data(), residues.size(), work.data());
+            break;
+        case Striped::Isa::SSE41:
+            best = ssv_sse41(layout, residues.data(), residues.size(), work.data());
+            break;
+        default:
+            best = ssv<Scalar>(layout, residues.data(), residues.size(), work.data());
+            break;
+    }
+    if (best == 255) {
+        return std::numeric_limits<float>::infinity();
+    }
+    return best / scale;
+}
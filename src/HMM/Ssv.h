@@ -0,0 +1,67 @@
+#ifndef PROJET_BIOINFO_WIRTH_SSV_H
+#define PROJET_BIOINFO_WIRTH_SSV_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Profile.h"
+#include "Striped.h"
+
+/**
+ * Préfiltre SSV ("single segment viterbi") : score du meilleur segment sans gap de la séquence sur les états M du
+ * modèle, en log-odds contre un modèle nul où les 20 acides aminés sont équiprobables. Beaucoup moins cher que viterbi,
+ * il sert à écarter les couples (modèle, séquence) sans ressemblance avant le calcul complet.
+ * Les scores sont arrondis sur un octet non signé (1/3 de bit par unité, saturé à 0 et 255) et calculés 16 ou 32 rangs
+ * à la fois, dans la disposition "striped" de Striped, par le même choix de jeu d'instructions. Chaque émission est
+ * arrondie à 1 / (2 scale) nat près : le score d'un segment de n acides aminés s'écarte de son log-odds d'au plus
+ * n / (2 scale) nats (0,12 nat par acide aminé).
+ */
+class Ssv {
+public:
+    // Probabilité d'un acide aminé sous le modèle nul
+    static constexpr float background = 1.0f / Alphabet::size;
+    // Unités d'un score par nat : 1/3 de bit
+    static constexpr float scale = 4.328085f;
+
+    /**
+     * Disposition mémoire, partagée avec les noyaux SIMD. Pour chaque code a de l'alphabet, Q vecteurs de coûts :
+     * bias - score arrondi de l'émission de a par M_k (255 si M_k n'émet pas a).
+     */
+    struct Layout {
+        std::size_t segments;
+        const std::uint8_t *costs;
+        std::uint8_t bias;
+    };
+
+    Ssv() = default;
+
+    /**
+     * @param profile le profil compilé
+     * @param isa le jeu d'instructions à utiliser (par défaut le meilleur disponible, comme Striped)
+     */
+    explicit Ssv(const Profile& profile, Striped::Isa isa = Striped::detect());
+
+    /**
+     * Score SSV de la séquence
+     * @param residues la séquence digitalisée (sans gap)
+     * @return le log-odds du meilleur segment, en nats (0 au minimum), +inf s'il dépasse la capacité d'un octet
+     */
+    [[nodiscard]] float score(const std::vector<std::uint8_t>& residues) const;
+
+private:
+    Striped::Isa isa_{Striped::Isa::Scalar};
+    std::size_t width_{1};
+    std::size_t segments_{};
+    std::vector<std::uint8_t> costs_;
+    std::uint8_t bias_{};
+};
+
+// Noyaux, un par jeu d'instructions. Renvoient le meilleur score arrondi, ou 255 en cas de dépassement.
+std::uint8_t ssv_sse41(const Ssv::Layout& layout, const std::uint8_t *residues, std::size_t length,
+                       std::uint8_t *work);
+std::uint8_t ssv_avx2(const Ssv::Layout& layout, const std::uint8_t *residues, std::size_t length,
+                      std::uint8_t *work);
+
+
+#endif //PROJET_BIOINFO_WIRTH_SSV_H
@@ -0,0 +1,45 @@
+// Noyau AVX2 du préfiltre : compilé pour ce jeu d'instructions, appelé uniquement si le processeur le supporte
+#include "Ssv.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#pragma GCC target("avx2")
+#include <immintrin.h>
+#endif
+
+#include "SsvKernel.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+namespace {
+
+struct Avx2 {
+    using V = __m256i;
+    static constexpr std::size_t width = 32;
+    static V load(const std::uint8_t *p) { return _mm256_loadu_si256(reinterpret_cast<const V *>(p)); }
+    static void store(std::uint8_t *p, V v) { _mm256_storeu_si256(reinterpret_cast<V *>(p), v); }
+    static V set1(std::uint8_t value) { return _mm256_set1_epi8(static_cast<char>(value)); }
+    static V adds(V a, V b) { return _mm256_adds_epu8(a, b); }
+    static V subs(V a, V b) { return _mm256_subs_epu8(a, b); }
+    static V max(V a, V b) { return _mm256_max_epu8(a, b); }
+    // Décalage d'un octet sur les 256 bits : l'octet 15 passe dans la moitié haute
+    static V shift(V v) { return _mm256_alignr_epi8(v, _mm256_permute2x128_si256(v, v, 0x08), 15); }
+    static std::uint8_t hmax(V v) {
+        __m128i half = _mm_max_epu8(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+        half = _mm_max_epu8(half, _mm_srli_si128(half, 8));
+        half = _mm_max_epu8(half, _mm_srli_si128(half, 4));
+        half = _mm_max_epu8(half, _mm_srli_si128(half, 2));
+        half = _mm_max_epu8(half, _mm_srli_si128(half, 1));
+        return static_cast<std::uint8_t>(_mm_extract_epi8(half, 0));
+    }
+};
+
+}
+
+std::uint8_t ssv_avx2(const Ssv::Layout& layout, const std::uint8_t *residues, std::size_t length,
+                      std::uint8_t *work) {
+    return ssv<Avx2>(layout, residues, length, work);
+}
+#else
+std::uint8_t ssv_avx2(const Ssv::Layout&, const std::uint8_t *, std::size_t, std::uint8_t *) {
+    return 255;
+}
+#endif
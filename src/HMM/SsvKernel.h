@@ -0,0 +1,50 @@
+#ifndef PROJET_BIOINFO_WIRTH_SSVKERNEL_H
+#define PROJET_BIOINFO_WIRTH_SSVKERNEL_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include "Ssv.h"
+
+// Noyau générique du préfiltre SSV, paramétré par les opérations vectorielles sur octets non signés S :
+//   S::width, S::V, S::load, S::store, S::set1, S::adds, S::subs (saturées), S::max, S::shift (décale d'une voie,
+//   0 en voie 0), S::hmax (maximum des voies).
+// Comme StripedKernel.h, il n'utilise aucun conteneur de la bibliothèque standard.
+namespace {
+
+template <class S>
+std::uint8_t ssv(const Ssv::Layout& layout, const std::uint8_t *residues, std::size_t length, std::uint8_t *work) {
+    using V = typename S::V;
+    constexpr std::size_t W = S::width;
+    const std::size_t Q = layout.segments;
+    const V bias = S::set1(layout.bias);
+    // Au delà, l'addition du biais sature : le score n'est plus exact
+    const std::uint8_t overflow = 255 - layout.bias;
+    V best = S::set1(0);
+
+    // Une seule colonne, mise à jour sur place : H[k][j] = max(0, H[k-1][j-1] + score(k, j))
+    for (std::size_t index = 0; index < Q * W; index++) {
+        work[index] = 0;
+    }
+    for (std::size_t j = 0; j < length; j++) {
+        const std::uint8_t *cost = layout.costs + residues[j] * Q * W;
+        // Le rang k-1 du segment 0 est le dernier segment de la colonne précédente, décalé d'une voie
+        V diagonal = S::shift(S::load(work + (Q - 1) * W));
+        for (std::size_t q = 0; q < Q; q++) {
+            V next = S::load(work + q * W);
+            V h = S::subs(S::adds(diagonal, bias), S::load(cost + q * W));
+            best = S::max(best, h);
+            S::store(work + q * W, h);
+            diagonal = next;
+        }
+        if (S::hmax(best) >= overflow) {
+            return 255;
+        }
+    }
+    return S::hmax(best);
+}
+
+}
+
+
+#endif //PROJET_BIOINFO_WIRTH_SSVKERNEL_H
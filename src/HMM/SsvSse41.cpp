@@ -0,0 +1,43 @@
+// Noyau SSE4.1 du préfiltre : compilé pour ce jeu d'instructions, appelé uniquement si le processeur le supporte
+#include "Ssv.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#pragma GCC target("sse4.1")
+#include <immintrin.h>
+#endif
+
+#include "SsvKernel.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+namespace {
+
+struct Sse41 {
+    using V = __m128i;
+    static constexpr std::size_t width = 16;
+    static V load(const std::uint8_t *p) { return _mm_loadu_si128(reinterpret_cast<const V *>(p)); }
+    static void store(std::uint8_t *p, V v) { _mm_storeu_si128(reinterpret_cast<V *>(p), v); }
+    static V set1(std::uint8_t value) { return _mm_set1_epi8(static_cast<char>(value)); }
+    static V adds(V a, V b) { return _mm_adds_epu8(a, b); }
+    static V subs(V a, V b) { return _mm_subs_epu8(a, b); }
+    static V max(V a, V b) { return _mm_max_epu8(a, b); }
+    static V shift(V v) { return _mm_slli_si128(v, 1); }
+    static std::uint8_t hmax(V v) {
+        v = _mm_max_epu8(v, _mm_srli_si128(v, 8));
+        v = _mm_max_epu8(v, _mm_srli_si128(v, 4));
+        v = _mm_max_epu8(v, _mm_srli_si128(v, 2));
+        v = _mm_max_epu8(v, _mm_srli_si128(v, 1));
+        return static_cast<std::uint8_t>(_mm_extract_epi8(v, 0));
+    }
+};
+
+}
+
+std::uint8_t ssv_sse41(const Ssv::Layout& layout, const std::uint8_t *residues, std::size_t length,
+                       std::uint8_t *work) {
+    return ssv<Sse41>(layout, residues, length, work);
+}
+#else
+std::uint8_t ssv_sse41(const Ssv::Layout&, const std::uint8_t *, std::size_t, std::uint8_t *) {
+    return 255;
+}
+#endif
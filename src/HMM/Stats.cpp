@@ -0,0 +1,52 @@
+#include <fstream>
+#include <string>
+#include <sys/resource.h>
+#include "Output.h"
+#include "Stats.h"
+
+void Stats::enable() {
+    start_ = clock::now();
+    enabled_ = true;
+}
+
+void Stats::report(std::ostream& stream) {
+    static constexpr const char *stage_names[stages] = {"parse", "load", "build", "prefilter", "fill", "traceback",
+                                                        "sample", "output"};
+    const double wall = std::chrono::duration<double>(clock::now() - start_).count();
+    const auto cells = counters_[static_cast<std::size_t>(Counter::cells)].load();
+    const auto sequences = counters_[static_cast<std::size_t>(Counter::sequences)].load();
+    Output out(stream);
+    out.precision(6);
+    out << "{\"wall_seconds\":";
+    out.json(wall);
+    out << ",\"stages\":{";
+    bool first = true;
+    for (std::size_t stage = 0; stage < stages; stage++) {
+        const auto nanoseconds = nanoseconds_[stage].load();
+        if (nanoseconds == 0) {
+            continue;
+        }
+        out << (first ? "" : ",") << '"' << stage_names[stage] << "\":";
+        out.json(static_cast<double>(nanoseconds) * 1e-9);
+        first = false;
+    }
+    out << "},\"cells\":" << cells << ",\"cells_per_second\":";
+    out.json(static_cast<double>(cells) / wall);
+    out << ",\"sequences\":" << sequences << ",\"sequences_per_second\":";
+    out.json(static_cast<double>(sequences) / wall);
+    out << ",\"bytes_read\":" << counters_[static_cast<std::size_t>(Counter::bytes_read)].load()
+        << ",\"peak_rss_kb\":" << peak_rss_kb() << "}\n";
+}
+
+long Stats::peak_rss_kb() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) {
+            return std::stol(line.substr(6));
+        }
+    }
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
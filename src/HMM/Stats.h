@@ -0,0 +1,113 @@
+#ifndef PROJET_BIOINFO_WIRTH_STATS_H
+#define PROJET_BIOINFO_WIRTH_STATS_H
+
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+/**
+ * Mesures d'exécution (option --stats des binaires) : durée de chaque étape, mesurée par des chronomètres de portée
+ * (Timer), et compteurs (cases calculées, séquences, octets lus). Les mesures sont globales au processus et partagées
+ * par tous les threads (additions atomiques).
+ * Tant que enable n'a pas été appelée, un chronomètre ou un compteur ne coûte qu'un test : les mesures peuvent rester
+ * dans le code. Les chronomètres sont posés à gros grain (une séquence, un bloc, un modèle), jamais par case.
+ */
+class Stats {
+public:
+    // Étapes chronométrées
+    enum class Stage {
+        // Lecture des enregistrements fasta et copie ou digitalisation des séquences
+        parse,
+        // Chargement des modèles (lecture et compilation du profil)
+        load,
+        // Comptes et normalisation de HMM-build
+        build,
+        // Préfiltre SSV
+        prefilter,
+        // Remplissage des matrices de programmation dynamique (viterbi, Forward, Backward), score seul compris
+        fill,
+        // Étape retour
+        traceback,
+        // Génération de séquences (HMM-genseq)
+        sample,
+        // Écriture des résultats
+        output
+    };
+    static constexpr std::size_t stages = 8;
+
+    enum class Counter {
+        // Cases de programmation dynamique calculées : rangs du modèle x acides aminés, pour chaque passe
+        cells,
+        // Séquences lues ou générées
+        sequences,
+        // Octets des fichiers lus (projetés en mémoire)
+        bytes_read
+    };
+    static constexpr std::size_t counters = 3;
+
+    /**
+     * Active les mesures, et démarre le chronomètre global. À appeler avant de lancer des threads.
+     */
+    static void enable();
+    [[nodiscard]] static bool enabled() { return enabled_; }
+
+    static void add(Counter counter, std::uint64_t value) {
+        if (enabled_) {
+            counters_[static_cast<std::size_t>(counter)].fetch_add(value, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Chronomètre de portée : la durée entre sa construction et sa destruction est ajoutée à l'étape. Les durées de
+     * plusieurs threads s'additionnent : pour une étape répartie entre threads, c'est le temps cumulé des threads.
+     */
+    class Timer {
+    public:
+        explicit Timer(Stage stage): stage_(stage), running_(enabled_) {
+            if (running_) {
+                start_ = clock::now();
+            }
+        }
+        Timer(const Timer&) = delete;
+        Timer& operator=(const Timer&) = delete;
+        ~Timer() {
+            if (running_) {
+                const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start_);
+                nanoseconds_[static_cast<std::size_t>(stage_)].fetch_add(static_cast<std::uint64_t>(elapsed.count()),
+                                                                         std::memory_order_relaxed);
+            }
+        }
+
+    private:
+        Stage stage_;
+        bool running_;
+        std::chrono::steady_clock::time_point start_;
+    };
+
+    /**
+     * Écriture des mesures en un objet JSON sur une ligne : durée totale (wall_seconds, depuis enable), durée de chaque
+     * étape chronométrée (les étapes jamais chronométrées sont omises), compteurs, débits rapportés à la durée totale
+     * (cells_per_second, sequences_per_second) et pic de mémoire résidente
+     * @param out le flux de sortie (la sortie d'erreur pour --stats)
+     */
+    static void report(std::ostream& out);
+
+    /**
+     * @return le pic de mémoire résidente du processus en Ko (Linux : VmHWM, sinon getrusage)
+     */
+    static long peak_rss_kb();
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    static inline bool enabled_ = false;
+    static inline clock::time_point start_;
+    static inline std::atomic<std::uint64_t> nanoseconds_[stages]{};
+    static inline std::atomic<std::uint64_t> counters_[counters]{};
+};
+
+
+#endif //PROJET_BIOINFO_WIRTH_STATS_H
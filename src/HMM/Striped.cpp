@@ -0,0 +1,78 @@
+#include <limits>
+#include "Striped.h"
+
+Striped::Striped(const Profile& profile, Isa isa)
+:isa_(isa),
+size_(profile.size())
+{
+    if (isa_ == Isa::Scalar || size_ == 0) {
+        isa_ = Isa::Scalar;
+        return;
+    }
+    width_ = isa_ == Isa::AVX2 ? 8 : 4;
+    segments_ = (size_ + width_ - 1) / width_;
+    const float minus_infinity = -1 * std::numeric_limits<float>::infinity();
+    transitions_.assign(segments_ * 9 * width_, minus_infinity);
+    match_.assign(Alphabet::codes * segments_ * width_, minus_infinity);
+    insert_.assign(Alphabet::codes * segments_ * width_, minus_infinity);
+    // Indices dans log(T[k][.]) : M->M, I->M, D->M, M->D, I->D, D->D (depuis le rang k-1), M->I, I->I, D->I (depuis k)
+    const std::size_t from_previous[6] = {0, 6, 3, 1, 7, 4};
+    const std::size_t from_current[3] = {2, 8, 5};
+    for (std::size_t k = 0; k < size_; k++) {
+        std::size_t q = k % segments_;
+        std::size_t lane = k / segments_;
+        // Le rang 0 n'a pas de prédécesseur : ses transitions entrantes restent à -inf
+        if (k > 0) {
+            for (std::size_t t = 0; t < 6; t++) {
+                transitions_[(q * 9 + t) * width_ + lane] = profile.transition(k - 1)[from_previous[t]];
+            }
+        }
+        for (std::size_t t = 0; t < 3; t++) {
+            transitions_[(q * 9 + 6 + t) * width_ + lane] = profile.transition(k)[from_current[t]];
+        }
+        for (std::size_t a = 0; a < Alphabet::codes; a++) {
+            match_[(a * segments_ + q) * width_ + lane] = profile.match(k)[a];
+            insert_[(a * segments_ + q) * width_ + lane] = profile.insert(k)[a];
+        }
+    }
+    end_[0] = profile.transition(size_ - 1)[0];
+    end_[1] = profile.transition(size_ - 1)[3];
+    end_[2] = profile.transition(size_ - 1)[6];
+}
+
+Striped::Isa Striped::detect() {
+#if defined(__x86_64__) || defined(__i386__)
+    if (__builtin_cpu_supports("avx2")) {
+        return Isa::AVX2;
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+        return Isa::SSE41;
+    }
+#endif
+    return Isa::Scalar;
+}
+
+float Striped::score(const std::vector<std::uint8_t>& residues) const {
+    // La colonne 0 n'est jamais calculée par la version scalaire : l'état final y vaut -inf
+    if (residues.empty()) {
+        return -1 * std::numeric_limits<float>::infinity();
+    }
+    std::vector<float> work(6 * segments_ * width_);
+    Layout layout{segments_, transitions_.data(), match_.data(), insert_.data()};
+    const float *column = isa_ == Isa::AVX2
+            ? striped_viterbi_avx2(layout, residues.data(), residues.size(), work.data())
+            : striped_viterbi_sse41(layout, residues.data(), residues.size(), work.data());
+    // État final : maximum depuis I, D puis M du dernier rang dans la dernière colonne, comme la version scalaire.
+    // L'état final n'émet pas : sa "constante" est nulle.
+    std::size_t last = ((size_ - 1) % segments_) * width_ + (size_ - 1) / segments_;
+    float max_value = -1 * std::numeric_limits<float>::infinity();
+    const float candidates[3] = {column[2 * segments_ * width_ + last] + end_[2],
+                                 column[segments_ * width_ + last] + end_[1],
+                                 column[last] + end_[0]};
+    for (auto candidate : candidates) {
+        if (candidate >= max_value) {
+            max_value = candidate;
+        }
+    }
+    return 0 + max_value;
+}
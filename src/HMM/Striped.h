@@ -0,0 +1,78 @@
+#ifndef PROJET_BIOINFO_WIRTH_STRIPED_H
+#define PROJET_BIOINFO_WIRTH_STRIPED_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Profile.h"
+
+/**
+ * Moteur de viterbi vectorisé (disposition "striped" de Farrar) pour le calcul du score uniquement.
+ * Les rangs du modèle sont répartis entre les voies d'un registre SIMD : le rang k est rangé dans le segment k % Q,
+ * voie k / Q, où Q est le nombre de segments. Les chaînes D -> D sont corrigées a posteriori (boucle "lazy-F").
+ * Le jeu d'instructions (AVX2, SSE4.1) est choisi à l'exécution ; sans l'un d'eux, le moteur n'est pas disponible
+ * et l'appelant doit utiliser l'implémentation scalaire.
+ */
+class Striped {
+public:
+    enum class Isa {
+        Scalar,
+        SSE41,
+        AVX2
+    };
+
+    /**
+     * Disposition mémoire du profil, partagée avec les noyaux SIMD.
+     * Pour chaque segment q : 9 vecteurs de transitions, dans l'ordre
+     * M->M, I->M, D->M (vers M_k depuis le rang k-1), M->D, I->D, D->D (vers D_k depuis k-1), M->I, I->I, D->I (vers I_k
+     * depuis k). Émissions : pour chaque code a de l'alphabet, Q vecteurs.
+     */
+    struct Layout {
+        std::size_t segments;
+        const float *transitions;
+        const float *match;
+        const float *insert;
+    };
+
+    Striped() = default;
+
+    /**
+     * Réorganisation du profil pour le jeu d'instructions donné
+     * @param profile le profil compilé
+     * @param isa le jeu d'instructions à utiliser (par défaut le meilleur disponible)
+     */
+    explicit Striped(const Profile& profile, Isa isa = detect());
+
+    // Meilleur jeu d'instructions disponible sur la machine
+    static Isa detect();
+
+    // Vrai si un noyau SIMD est utilisable
+    [[nodiscard]] bool available() const { return isa_ != Isa::Scalar; }
+
+    /**
+     * Score de viterbi de la séquence (identique à V[3N][L] de l'implémentation scalaire)
+     * @param residues la séquence digitalisée (sans gap)
+     */
+    [[nodiscard]] float score(const std::vector<std::uint8_t>& residues) const;
+
+private:
+    Isa isa_{Isa::Scalar};
+    std::size_t size_{};
+    std::size_t width_{1};
+    std::size_t segments_{};
+    std::vector<float> transitions_;
+    std::vector<float> match_;
+    std::vector<float> insert_;
+    // log(T[N-1][.]) vers l'état final depuis M, D, I
+    float end_[3]{};
+};
+
+// Noyaux, un par jeu d'instructions. Écrivent la dernière colonne (M, D, I) dans work et renvoient son adresse.
+const float *striped_viterbi_sse41(const Striped::Layout& layout, const std::uint8_t *residues, std::size_t length,
+                                   float *work);
+const float *striped_viterbi_avx2(const Striped::Layout& layout, const std::uint8_t *residues, std::size_t length,
+                                  float *work);
+
+
+#endif //PROJET_BIOINFO_WIRTH_STRIPED_H
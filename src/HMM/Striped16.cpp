@@ -0,0 +1,118 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "Striped16.h"
+
+namespace {
+
+// Plancher des entiers 16 bits : -inf
+constexpr std::int16_t floor16 = -32768;
+// Plus grande valeur absolue d'un terme fini arrondi, pour garder de la marge au dessus du plancher (voir le noyau)
+constexpr int max_guard = 8192;
+
+}
+
+Striped16::Striped16(const Profile& profile, Striped::Isa isa)
+:isa_(isa),
+size_(profile.size())
+{
+    if (isa_ == Striped::Isa::Scalar || size_ == 0) {
+        isa_ = Striped::Isa::Scalar;
+        return;
+    }
+    width_ = isa_ == Striped::Isa::AVX2 ? 16 : 8;
+    segments_ = (size_ + width_ - 1) / width_;
+    // Meilleure émission de chaque code, en M ou en I : les émissions arrondies lui sont rapportées
+    best_emission_.assign(Alphabet::codes, -1 * std::numeric_limits<float>::infinity());
+    for (std::size_t k = 0; k < size_; k++) {
+        for (std::size_t a = 0; a < Alphabet::codes; a++) {
+            best_emission_[a] = std::max({best_emission_[a], profile.match(k)[a], profile.insert(k)[a]});
+        }
+    }
+    for (auto & best : best_emission_) {
+        if (std::isinf(best)) {
+            best = 0;
+        }
+    }
+    int guard = 0;
+    auto quantize = [&guard](float value) {
+        if (std::isinf(value)) {
+            return floor16;
+        }
+        const long rounded = std::lround(scale * value);
+        guard = static_cast<int>(std::min<long>(std::max<long>(guard, -rounded), max_guard + 1));
+        return static_cast<std::int16_t>(std::max<long>(rounded, -max_guard));
+    };
+    transitions_.assign(segments_ * 9 * width_, floor16);
+    match_.assign(Alphabet::codes * segments_ * width_, floor16);
+    insert_.assign(Alphabet::codes * segments_ * width_, floor16);
+    // Même disposition que Striped
+    const std::size_t from_previous[6] = {0, 6, 3, 1, 7, 4};
+    const std::size_t from_current[3] = {2, 8, 5};
+    for (std::size_t k = 0; k < size_; k++) {
+        std::size_t q = k % segments_;
+        std::size_t lane = k / segments_;
+        if (k > 0) {
+            for (std::size_t t = 0; t < 6; t++) {
+                transitions_[(q * 9 + t) * width_ + lane] = quantize(profile.transition(k - 1)[from_previous[t]]);
+            }
+        }
+        for (std::size_t t = 0; t < 3; t++) {
+            transitions_[(q * 9 + 6 + t) * width_ + lane] = quantize(profile.transition(k)[from_current[t]]);
+        }
+        for (std::size_t a = 0; a < Alphabet::codes; a++) {
+            match_[(a * segments_ + q) * width_ + lane] = quantize(profile.match(k)[a] - best_emission_[a]);
+            insert_[(a * segments_ + q) * width_ + lane] = quantize(profile.insert(k)[a] - best_emission_[a]);
+        }
+    }
+    // Un terme fini trop petit pour la marge : le moteur n'est pas utilisable pour ce modèle
+    if (guard > max_guard) {
+        isa_ = Striped::Isa::Scalar;
+        return;
+    }
+    guard_ = static_cast<std::int16_t>(guard);
+    end_[0] = profile.transition(size_ - 1)[0];
+    end_[1] = profile.transition(size_ - 1)[3];
+    end_[2] = profile.transition(size_ - 1)[6];
+}
+
+std::optional<float> Striped16::score(const std::vector<std::uint8_t>& residues) const {
+    if (residues.empty()) {
+        return -1 * std::numeric_limits<float>::infinity();
+    }
+    std::vector<std::int16_t> work(6 * segments_ * width_);
+    Layout layout{segments_, transitions_.data(), match_.data(), insert_.data(), guard_};
+    std::int64_t offset = 0;
+    std::int64_t floor_offset = -1;
+    const std::int16_t *column = isa_ == Striped::Isa::AVX2
+            ? striped_viterbi16_avx2(layout, residues.data(), residues.size(), work.data(), &offset, &floor_offset)
+            : striped_viterbi16_sse41(layout, residues.data(), residues.size(), work.data(), &offset, &floor_offset);
+    if (column == nullptr) {
+        return std::nullopt;
+    }
+    // Score d'une case : émissions retranchées et relèvements rendus, en nats
+    double base = -static_cast<double>(offset) / scale;
+    for (auto residue : residues) {
+        base += best_emission_[residue];
+    }
+    const std::size_t last = ((size_ - 1) % segments_) * width_ + (size_ - 1) / segments_;
+    const std::int16_t cells[3] = {column[2 * segments_ * width_ + last], column[segments_ * width_ + last],
+                                   column[last]};
+    const float ends[3] = {end_[2], end_[1], end_[0]};
+    float max_value = -1 * std::numeric_limits<float>::infinity();
+    double best = -1 * std::numeric_limits<double>::infinity();
+    for (std::size_t s = 0; s < 3; s++) {
+        if (cells[s] == floor16) {
+            continue;
+        }
+        const double cell = cells[s] / scale + ends[s];
+        best = std::max(best, cell);
+        max_value = std::max(max_value, static_cast<float>(base + cell));
+    }
+    // Un chemin perdu au plancher finit sous le plancher relevé depuis la colonne où il a pu saturer : le meilleur
+    // chemin calculé doit le dépasser, sinon le score est recalculé en flottants
+    if (floor_offset >= 0 && best <= (floor16 + static_cast<double>(offset - floor_offset)) / scale) {
+        return std::nullopt;
+    }
+    return max_value;
+}
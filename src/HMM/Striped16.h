@@ -0,0 +1,90 @@
+#ifndef PROJET_BIOINFO_WIRTH_STRIPED16_H
+#define PROJET_BIOINFO_WIRTH_STRIPED16_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+#include "Profile.h"
+#include "Striped.h"
+
+/**
+ * Moteur de viterbi vectorisé sur entiers 16 bits signés, pour le calcul du score seul : même disposition "striped"
+ * que Striped, avec deux fois plus de voies par registre (8 en SSE4.1, 16 en AVX2).
+ * Les logarithmes du profil sont arrondis en unités de 1/scale nat. Pour que tous les termes soient négatifs, chaque
+ * émission est rapportée à la meilleure émission du même acide aminé sur tout le modèle, qui est ajoutée (sans
+ * arrondi) au score final. -32768 représente -inf : les additions saturées le laissent en place.
+ * Les valeurs d'une colonne sont relatives à un décalage, relevé quand leur maximum descend trop bas. Une valeur qui
+ * sature reste au plancher : le score entier ne peut que perdre des chemins. Il est exact (aux arrondis près) s'il
+ * dépasse tout ce qu'un chemin perdu aurait pu atteindre ; sinon, l'appelant recalcule le score en flottants. C'est le
+ * cas des séquences beaucoup plus longues que le modèle, pour lesquelles le calcul s'arrête au plus tôt.
+ * Écart au score flottant : chaque terme arrondi est à au plus 1 / (2 scale) nat de sa valeur, et le meilleur chemin
+ * d'une séquence de L acides aminés sur N rangs compte au plus 2 L + N termes arrondis (une transition et une émission
+ * par acide aminé, une transition par état D), d'où |écart| <= (2 L + N) / (2 scale) nats. Les arrondis d'une même
+ * transition s'ajoutent le long des chaînes D ou I : l'écart observé va de quelques dixièmes de nat à environ 1,5 nat
+ * (séquences courtes sur un long modèle).
+ */
+class Striped16 {
+public:
+    // Unités d'un score par nat
+    static constexpr float scale = 32.0f;
+
+    /**
+     * Disposition mémoire, partagée avec les noyaux SIMD : celle de Striped::Layout, en entiers.
+     * guard est la plus grande valeur absolue d'un terme fini : une valeur finie à moins de 2 guard du plancher arrête
+     * le calcul.
+     */
+    struct Layout {
+        std::size_t segments;
+        const std::int16_t *transitions;
+        const std::int16_t *match;
+        const std::int16_t *insert;
+        std::int16_t guard;
+    };
+
+    Striped16() = default;
+
+    /**
+     * @param profile le profil compilé
+     * @param isa le jeu d'instructions à utiliser (par défaut le meilleur disponible, comme Striped)
+     */
+    explicit Striped16(const Profile& profile, Striped::Isa isa = Striped::detect());
+
+    // Vrai si un noyau SIMD est utilisable et que les termes du profil tiennent sur 16 bits
+    [[nodiscard]] bool available() const { return isa_ != Striped::Isa::Scalar; }
+
+    /**
+     * Score de viterbi de la séquence, à l'écart d'arrondi près (voir ci-dessus)
+     * @param residues la séquence digitalisée (sans gap)
+     * @return le score, ou rien si le calcul a saturé
+     */
+    [[nodiscard]] std::optional<float> score(const std::vector<std::uint8_t>& residues) const;
+
+private:
+    Striped::Isa isa_{Striped::Isa::Scalar};
+    std::size_t size_{};
+    std::size_t width_{1};
+    std::size_t segments_{};
+    std::vector<std::int16_t> transitions_;
+    std::vector<std::int16_t> match_;
+    std::vector<std::int16_t> insert_;
+    // Meilleure émission (M ou I) de chaque code de l'alphabet, retranchée des émissions arrondies
+    std::vector<float> best_emission_;
+    std::int16_t guard_{};
+    // log(T[N-1][.]) vers l'état final depuis M, D, I (non arrondis)
+    float end_[3]{};
+};
+
+// Noyaux, un par jeu d'instructions. Écrivent la dernière colonne (M, D, I) dans work et renvoient son adresse, ou
+// nullptr si le score ne pourra pas être vérifié ; offset reçoit la somme des relèvements des colonnes (en unités),
+// floor_offset sa valeur avant la première colonne où une valeur finie a pu saturer (-1 si aucune).
+const std::int16_t *striped_viterbi16_sse41(const Striped16::Layout& layout, const std::uint8_t *residues,
+                                            std::size_t length, std::int16_t *work, std::int64_t *offset,
+                                            std::int64_t *floor_offset);
+const std::int16_t *striped_viterbi16_avx2(const Striped16::Layout& layout, const std::uint8_t *residues,
+                                           std::size_t length, std::int16_t *work, std::int64_t *offset,
+                                           std::int64_t *floor_offset);
+
+
+#endif //PROJET_BIOINFO_WIRTH_STRIPED16_H
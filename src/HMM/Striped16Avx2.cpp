@@ -0,0 +1,57 @@
+// Noyau AVX2 sur entiers 16 bits : compilé pour ce jeu d'instructions, appelé uniquement si le processeur le supporte
+#include "Striped16.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#pragma GCC target("avx2")
+#include <immintrin.h>
+#endif
+
+#include "Striped16Kernel.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+namespace {
+
+struct Avx2 {
+    using V = __m256i;
+    static constexpr std::size_t width = 16;
+    static V load(const std::int16_t *p) { return _mm256_loadu_si256(reinterpret_cast<const V *>(p)); }
+    static void store(std::int16_t *p, V v) { _mm256_storeu_si256(reinterpret_cast<V *>(p), v); }
+    static V set1(std::int16_t value) { return _mm256_set1_epi16(value); }
+    static V adds(V a, V b) { return _mm256_adds_epi16(a, b); }
+    static V max(V a, V b) { return _mm256_max_epi16(a, b); }
+    // Décalage d'une voie à travers les deux moitiés de 128 bits : la moitié haute reçoit la dernière voie de la basse
+    static V shift(V v) {
+        V shifted = _mm256_alignr_epi8(v, _mm256_permute2x128_si256(v, v, 0x08), 14);
+        return _mm256_or_si256(shifted, _mm256_setr_epi16(-32768, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0));
+    }
+    static bool any_greater(V a, V b) { return _mm256_movemask_epi8(_mm256_cmpgt_epi16(a, b)) != 0; }
+    static std::int16_t hmax(V v) {
+        __m128i half = _mm_max_epi16(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+        half = _mm_max_epi16(half, _mm_srli_si128(half, 8));
+        half = _mm_max_epi16(half, _mm_srli_si128(half, 4));
+        half = _mm_max_epi16(half, _mm_srli_si128(half, 2));
+        return static_cast<std::int16_t>(_mm_extract_epi16(half, 0));
+    }
+    static V near_floor(V v, V band) {
+        return _mm256_subs_epu16(band, _mm256_sub_epi16(v, _mm256_set1_epi16(-32767)));
+    }
+    static V merge(V a, V b) { return _mm256_or_si256(a, b); }
+    static bool any(V v) { return !_mm256_testz_si256(v, v); }
+    static V raise(V v, V r) {
+        return _mm256_blendv_epi8(_mm256_adds_epi16(v, r), v, _mm256_cmpeq_epi16(v, _mm256_set1_epi16(-32768)));
+    }
+};
+
+}
+
+const std::int16_t *striped_viterbi16_avx2(const Striped16::Layout& layout, const std::uint8_t *residues,
+                                           std::size_t length, std::int16_t *work, std::int64_t *offset,
+                                           std::int64_t *floor_offset) {
+    return striped_viterbi16<Avx2>(layout, residues, length, work, offset, floor_offset);
+}
+#else
+const std::int16_t *striped_viterbi16_avx2(const Striped16::Layout&, const std::uint8_t *, std::size_t,
+                                           std::int16_t *, std::int64_t *, std::int64_t *) {
+    return nullptr;
+}
+#endif
@@ -0,0 +1,147 @@
+#ifndef PROJET_BIOINFO_WIRTH_STRIPED16KERNEL_H
+#define PROJET_BIOINFO_WIRTH_STRIPED16KERNEL_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include "Striped16.h"
+
+// Noyau générique de viterbi "striped" sur entiers 16 bits, paramétré par les opérations vectorielles S :
+//   S::width, S::V, S::load, S::store, S::set1, S::adds (saturée), S::max, S::shift (décale d'une voie, -32768 en
+//   voie 0), S::any_greater, S::hmax (maximum des voies), S::near_floor (non nul dans les voies finies à au plus band
+//   du plancher), S::merge (ou bit à bit), S::any (vrai si une voie est non nulle), S::raise (ajoute r aux voies
+//   finies).
+// Mêmes récurrences que StripedKernel.h ; comme lui, il n'utilise aucun conteneur de la bibliothèque standard.
+// Tous les termes étant négatifs, une valeur qui sature reste au plancher : le chemin qui y passe est perdu, mais
+// aucune valeur n'est surestimée. Un chemin ne peut saturer que depuis une valeur à moins de deux termes du plancher ;
+// à partir de la première colonne où il y en a, sa valeur finale reste sous le plancher relevé de tous les
+// relèvements suivants (floor_offset) : le calcul s'arrête dès que ces relèvements dépassent l'amplitude des entiers.
+namespace {
+
+template <class S>
+const std::int16_t *striped_viterbi16(const Striped16::Layout& layout, const std::uint8_t *residues,
+                                      std::size_t length, std::int16_t *work, std::int64_t *offset,
+                                      std::int64_t *floor_offset) {
+    using V = typename S::V;
+    constexpr std::size_t W = S::width;
+    constexpr std::int16_t floor = -32768;
+    // Une colonne dont le maximum passe sous ce seuil est relevée à 0
+    constexpr std::int16_t low = -4096;
+    const std::size_t Q = layout.segments;
+    const V minus_infinity = S::set1(floor);
+    // Une valeur finie à plus de deux termes du plancher ne peut pas saturer dans la colonne suivante
+    const V band = S::set1(static_cast<std::int16_t>(2 * layout.guard));
+    std::int16_t *current = work;
+    std::int16_t *previous = work + 3 * Q * W;
+    *offset = 0;
+    *floor_offset = -1;
+
+    // Colonne 0 : tout à -inf, sauf M0 = 0 (segment 0, voie 0)
+    for (std::size_t index = 0; index < 3 * Q * W; index++) {
+        previous[index] = floor;
+    }
+    previous[0] = 0;
+
+    for (std::size_t j = 0; j < length; j++) {
+        const std::int16_t *match = layout.match + residues[j] * Q * W;
+        const std::int16_t *insert = layout.insert + residues[j] * Q * W;
+        std::int16_t *previous_M = previous;
+        std::int16_t *previous_D = previous + Q * W;
+        std::int16_t *previous_I = previous + 2 * Q * W;
+        std::int16_t *current_M = current;
+        std::int16_t *current_D = current + Q * W;
+        std::int16_t *current_I = current + 2 * Q * W;
+        // Maximum de la colonne, et voies proches du plancher
+        V top = minus_infinity;
+        V near = S::set1(0);
+
+        // États M et I
+        V m_previous = S::shift(S::load(previous_M + (Q - 1) * W));
+        V d_previous = S::shift(S::load(previous_D + (Q - 1) * W));
+        V i_previous = S::shift(S::load(previous_I + (Q - 1) * W));
+        for (std::size_t q = 0; q < Q; q++) {
+            const std::int16_t *t = layout.transitions + q * 9 * W;
+            V m = S::max(S::max(S::adds(i_previous, S::load(t + 1 * W)), S::adds(d_previous, S::load(t + 2 * W))),
+                         S::adds(m_previous, S::load(t)));
+            m = S::adds(S::load(match + q * W), m);
+            S::store(current_M + q * W, m);
+            m_previous = S::load(previous_M + q * W);
+            d_previous = S::load(previous_D + q * W);
+            i_previous = S::load(previous_I + q * W);
+            V i = S::max(S::max(S::adds(i_previous, S::load(t + 7 * W)), S::adds(d_previous, S::load(t + 8 * W))),
+                         S::adds(m_previous, S::load(t + 6 * W)));
+            i = S::adds(S::load(insert + q * W), i);
+            S::store(current_I + q * W, i);
+            top = S::max(top, S::max(m, i));
+            near = S::merge(near, S::merge(S::near_floor(m, band), S::near_floor(i, band)));
+        }
+
+        // État D, premier passage puis boucle lazy-F. Les valeurs de D ne font qu'augmenter d'un passage à l'autre :
+        // les suivre toutes majore le maximum, et ne peut que signaler à tort une valeur proche du plancher.
+        V m_before = S::shift(S::load(current_M + (Q - 1) * W));
+        V i_before = S::shift(S::load(current_I + (Q - 1) * W));
+        V d_before = minus_infinity;
+        for (std::size_t q = 0; q < Q; q++) {
+            const std::int16_t *t = layout.transitions + q * 9 * W;
+            V d = S::max(S::max(S::adds(i_before, S::load(t + 4 * W)), S::adds(d_before, S::load(t + 5 * W))),
+                         S::adds(m_before, S::load(t + 3 * W)));
+            S::store(current_D + q * W, d);
+            top = S::max(top, d);
+            near = S::merge(near, S::near_floor(d, band));
+            m_before = S::load(current_M + q * W);
+            i_before = S::load(current_I + q * W);
+            d_before = d;
+        }
+        for (std::size_t pass = 0; pass < W; pass++) {
+            d_before = S::shift(S::load(current_D + (Q - 1) * W));
+            bool changed = false;
+            for (std::size_t q = 0; q < Q; q++) {
+                V candidate = S::adds(d_before, S::load(layout.transitions + q * 9 * W + 5 * W));
+                V d = S::load(current_D + q * W);
+                if (!S::any_greater(candidate, d)) {
+                    changed = false;
+                    break;
+                }
+                changed = true;
+                d = S::max(d, candidate);
+                S::store(current_D + q * W, d);
+                top = S::max(top, d);
+                near = S::merge(near, S::near_floor(d, band));
+                d_before = d;
+            }
+            if (!changed) {
+                break;
+            }
+        }
+
+        // Une valeur finie proche du plancher a pu saturer dans cette colonne, ou saturera dans la suivante
+        if (*floor_offset < 0 && S::any(near)) {
+            *floor_offset = *offset;
+        }
+        // Relèvement : le maximum revient à 0, -inf reste en place. Tous les termes étant négatifs, les valeurs ne
+        // dépassent jamais 0.
+        const std::int16_t maximum = S::hmax(top);
+        if (maximum != floor && maximum < low) {
+            const V r = S::set1(static_cast<std::int16_t>(-maximum));
+            for (std::size_t index = 0; index < 3 * Q; index++) {
+                S::store(current + index * W, S::raise(S::load(current + index * W), r));
+            }
+            *offset += -maximum;
+            // Un chemin perdu pourrait désormais dépasser toute valeur représentable : le score entier ne sera pas
+            // vérifiable, autant arrêter
+            if (*floor_offset >= 0 && *offset - *floor_offset >= -floor) {
+                return nullptr;
+            }
+        }
+
+        std::int16_t *swap = previous;
+        previous = current;
+        current = swap;
+    }
+    return previous;
+}
+
+}
+
+
+#endif //PROJET_BIOINFO_WIRTH_STRIPED16KERNEL_H
@@ -0,0 +1,51 @@
+// Noyau SSE4.1 sur entiers 16 bits : compilé pour ce jeu d'instructions, appelé uniquement si le processeur le supporte
+#include "Striped16.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#pragma GCC target("sse4.1")
+#include <immintrin.h>
+#endif
+
+#include "Striped16Kernel.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+namespace {
+
+struct Sse41 {
+    using V = __m128i;
+    static constexpr std::size_t width = 8;
+    static V load(const std::int16_t *p) { return _mm_loadu_si128(reinterpret_cast<const V *>(p)); }
+    static void store(std::int16_t *p, V v) { _mm_storeu_si128(reinterpret_cast<V *>(p), v); }
+    static V set1(std::int16_t value) { return _mm_set1_epi16(value); }
+    static V adds(V a, V b) { return _mm_adds_epi16(a, b); }
+    static V max(V a, V b) { return _mm_max_epi16(a, b); }
+    static V shift(V v) { return _mm_or_si128(_mm_slli_si128(v, 2), _mm_setr_epi16(-32768, 0, 0, 0, 0, 0, 0, 0)); }
+    static bool any_greater(V a, V b) { return _mm_movemask_epi8(_mm_cmpgt_epi16(a, b)) != 0; }
+    static std::int16_t hmax(V v) {
+        v = _mm_max_epi16(v, _mm_srli_si128(v, 8));
+        v = _mm_max_epi16(v, _mm_srli_si128(v, 4));
+        v = _mm_max_epi16(v, _mm_srli_si128(v, 2));
+        return static_cast<std::int16_t>(_mm_extract_epi16(v, 0));
+    }
+    // v - (plancher + 1) vaut 0xffff pour -inf, et est inférieur à band (non signé) près du plancher
+    static V near_floor(V v, V band) { return _mm_subs_epu16(band, _mm_sub_epi16(v, _mm_set1_epi16(-32767))); }
+    static V merge(V a, V b) { return _mm_or_si128(a, b); }
+    static bool any(V v) { return !_mm_testz_si128(v, v); }
+    static V raise(V v, V r) {
+        return _mm_blendv_epi8(_mm_adds_epi16(v, r), v, _mm_cmpeq_epi16(v, _mm_set1_epi16(-32768)));
+    }
+};
+
+}
+
+const std::int16_t *striped_viterbi16_sse41(const Striped16::Layout& layout, const std::uint8_t *residues,
+                                            std::size_t length, std::int16_t *work, std::int64_t *offset,
+                                            std::int64_t *floor_offset) {
+    return striped_viterbi16<Sse41>(layout, residues, length, work, offset, floor_offset);
+}
+#else
+const std::int16_t *striped_viterbi16_sse41(const Striped16::Layout&, const std::uint8_t *, std::size_t,
+                                            std::int16_t *, std::int64_t *, std::int64_t *) {
+    return nullptr;
+}
+#endif
@@ -0,0 +1,39 @@
+// Noyau AVX2 : compilé pour ce jeu d'instructions, appelé uniquement si le processeur le supporte
+#include "Striped.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#pragma GCC target("avx2")
+#include <immintrin.h>
+#endif
+
+#include "StripedKernel.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+namespace {
+
+struct Avx2 {
+    using V = __m256;
+    static constexpr std::size_t width = 8;
+    static V load(const float *p) { return _mm256_loadu_ps(p); }
+    static void store(float *p, V v) { _mm256_storeu_ps(p, v); }
+    static V set1(float value) { return _mm256_set1_ps(value); }
+    static V add(V a, V b) { return _mm256_add_ps(a, b); }
+    static V max(V a, V b) { return _mm256_max_ps(a, b); }
+    static V shift(V v) {
+        V shifted = _mm256_permutevar8x32_ps(v, _mm256_setr_epi32(0, 0, 1, 2, 3, 4, 5, 6));
+        return _mm256_blend_ps(shifted, _mm256_set1_ps(-__builtin_inff()), 1);
+    }
+    static bool any_greater(V a, V b) { return _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_GT_OQ)) != 0; }
+};
+
+}
+
+const float *striped_viterbi_avx2(const Striped::Layout& layout, const std::uint8_t *residues, std::size_t length,
+                                  float *work) {
+    return striped_viterbi<Avx2>(layout, residues, length, work);
+}
+#else
+const float *striped_viterbi_avx2(const Striped::Layout&, const std::uint8_t *, std::size_t, float *) {
+    return nullptr;
+}
+#endif
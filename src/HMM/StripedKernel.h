@@ -0,0 +1,106 @@
+#ifndef PROJET_BIOINFO_WIRTH_STRIPEDKERNEL_H
+#define PROJET_BIOINFO_WIRTH_STRIPEDKERNEL_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include "Striped.h"
+
+// Noyau générique de viterbi "striped", paramétré par les opérations vectorielles S :
+//   S::width, S::V, S::load, S::store, S::set1, S::add, S::max, S::shift (décale d'une voie, -inf en voie 0),
+//   S::any_greater (vrai si une voie de a est strictement supérieure à celle de b).
+// Ce fichier n'est inclus que par les unités de compilation spécifiques à un jeu d'instructions : il ne doit utiliser
+// aucun conteneur de la bibliothèque standard, dont le code serait sinon partagé avec le reste du programme.
+namespace {
+
+template <class S>
+const float *striped_viterbi(const Striped::Layout& layout, const std::uint8_t *residues, std::size_t length,
+                             float *work) {
+    using V = typename S::V;
+    constexpr std::size_t W = S::width;
+    const std::size_t Q = layout.segments;
+    const V minus_infinity = S::set1(-__builtin_inff());
+    // Deux colonnes M, D, I de Q vecteurs chacune, utilisées en alternance
+    float *current = work;
+    float *previous = work + 3 * Q * W;
+
+    // Colonne 0 : tout à -inf, sauf M0 = 0 (segment 0, voie 0)
+    for (std::size_t index = 0; index < 3 * Q * W; index++) {
+        previous[index] = -__builtin_inff();
+    }
+    previous[0] = 0;
+
+    for (std::size_t j = 0; j < length; j++) {
+        const float *match = layout.match + residues[j] * Q * W;
+        const float *insert = layout.insert + residues[j] * Q * W;
+        float *previous_M = previous;
+        float *previous_D = previous + Q * W;
+        float *previous_I = previous + 2 * Q * W;
+        float *current_M = current;
+        float *current_D = current + Q * W;
+        float *current_I = current + 2 * Q * W;
+
+        // États M et I : ne dépendent que de la colonne précédente. Le rang k-1 du segment 0 est le dernier segment
+        // décalé d'une voie.
+        V m_previous = S::shift(S::load(previous_M + (Q - 1) * W));
+        V d_previous = S::shift(S::load(previous_D + (Q - 1) * W));
+        V i_previous = S::shift(S::load(previous_I + (Q - 1) * W));
+        for (std::size_t q = 0; q < Q; q++) {
+            const float *t = layout.transitions + q * 9 * W;
+            V m = S::max(S::max(S::add(i_previous, S::load(t + 1 * W)), S::add(d_previous, S::load(t + 2 * W))),
+                         S::add(m_previous, S::load(t)));
+            S::store(current_M + q * W, S::add(S::load(match + q * W), m));
+            m_previous = S::load(previous_M + q * W);
+            d_previous = S::load(previous_D + q * W);
+            i_previous = S::load(previous_I + q * W);
+            V i = S::max(S::max(S::add(i_previous, S::load(t + 7 * W)), S::add(d_previous, S::load(t + 8 * W))),
+                         S::add(m_previous, S::load(t + 6 * W)));
+            S::store(current_I + q * W, S::add(S::load(insert + q * W), i));
+        }
+
+        // État D : dépend des rangs précédents de la même colonne. Premier passage sans la chaîne D -> D venant du
+        // segment précédent pour le segment 0.
+        V m_before = S::shift(S::load(current_M + (Q - 1) * W));
+        V i_before = S::shift(S::load(current_I + (Q - 1) * W));
+        V d_before = minus_infinity;
+        for (std::size_t q = 0; q < Q; q++) {
+            const float *t = layout.transitions + q * 9 * W;
+            V d = S::max(S::max(S::add(i_before, S::load(t + 4 * W)), S::add(d_before, S::load(t + 5 * W))),
+                         S::add(m_before, S::load(t + 3 * W)));
+            S::store(current_D + q * W, d);
+            m_before = S::load(current_M + q * W);
+            i_before = S::load(current_I + q * W);
+            d_before = d;
+        }
+        // Boucle lazy-F : propagation des chaînes D -> D d'une voie à la suivante, tant qu'elle change quelque chose
+        for (std::size_t pass = 0; pass < W; pass++) {
+            d_before = S::shift(S::load(current_D + (Q - 1) * W));
+            bool changed = false;
+            for (std::size_t q = 0; q < Q; q++) {
+                V candidate = S::add(d_before, S::load(layout.transitions + q * 9 * W + 5 * W));
+                V d = S::load(current_D + q * W);
+                if (!S::any_greater(candidate, d)) {
+                    changed = false;
+                    break;
+                }
+                changed = true;
+                d = S::max(d, candidate);
+                S::store(current_D + q * W, d);
+                d_before = d;
+            }
+            if (!changed) {
+                break;
+            }
+        }
+
+        float *swap = previous;
+        previous = current;
+        current = swap;
+    }
+    return previous;
+}
+
+}
+
+
+#endif //PROJET_BIOINFO_WIRTH_STRIPEDKERNEL_H
@@ -0,0 +1,39 @@
+// Noyau SSE4.1 : compilé pour ce jeu d'instructions, appelé uniquement si le processeur le supporte
+#include "Striped.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#pragma GCC target("sse4.1")
+#include <immintrin.h>
+#endif
+
+#include "StripedKernel.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+namespace {
+
+struct Sse41 {
+    using V = __m128;
+    static constexpr std::size_t width = 4;
+    static V load(const float *p) { return _mm_loadu_ps(p); }
+    static void store(float *p, V v) { _mm_storeu_ps(p, v); }
+    static V set1(float value) { return _mm_set1_ps(value); }
+    static V add(V a, V b) { return _mm_add_ps(a, b); }
+    static V max(V a, V b) { return _mm_max_ps(a, b); }
+    static V shift(V v) {
+        V shifted = _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(v), 4));
+        return _mm_blend_ps(shifted, _mm_set1_ps(-__builtin_inff()), 1);
+    }
+    static bool any_greater(V a, V b) { return _mm_movemask_ps(_mm_cmpgt_ps(a, b)) != 0; }
+};
+
+}
+
+const float *striped_viterbi_sse41(const Striped::Layout& layout, const std::uint8_t *residues, std::size_t length,
+                                   float *work) {
+    return striped_viterbi<Sse41>(layout, residues, length, work);
+}
+#else
+const float *striped_viterbi_sse41(const Striped::Layout&, const std::uint8_t *, std::size_t, float *) {
+    return nullptr;
+}
+#endif
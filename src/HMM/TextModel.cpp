@@ -0,0 +1,93 @@
+#include <charconv>
+#include <stdexcept>
+#include "TextModel.h"
+
+TextModel::TextModel(const char *begin, const char *end)
+:position_(begin),
+end_(end)
+{
+}
+
+bool TextModel::at_end() {
+    skip_blanks(true);
+    return position_ == end_;
+}
+
+std::optional<std::string> TextModel::name() {
+    skip_blanks(true);
+    if (position_ == end_ || *position_ != '>') {
+        return std::nullopt;
+    }
+    position_++;
+    skip_blanks(false);
+    const char *begin = position_;
+    while (position_ != end_ && *position_ != '\n') {
+        position_++;
+    }
+    const char *last = position_;
+    while (last != begin && (last[-1] == ' ' || last[-1] == '\t' || last[-1] == '\r')) {
+        last--;
+    }
+    end_line();
+    return std::string(begin, last);
+}
+
+std::size_t TextModel::size() {
+    skip_blanks(true);
+    std::size_t size = 0;
+    const auto result = std::from_chars(position_, end_, size);
+    if (result.ec != std::errc() || size == 0) {
+        fail("expected the model size N");
+    }
+    position_ = result.ptr;
+    end_line();
+    return size;
+}
+
+void TextModel::read_row(float *values, std::size_t columns) {
+    skip_blanks(true);
+    if (position_ == end_) {
+        fail("missing line");
+    }
+    for (std::size_t column = 0; column < columns; column++) {
+        if (column != 0) {
+            skip_blanks(false);
+            if (position_ == end_ || *position_ != ',') {
+                fail("expected " + std::to_string(columns) + " values");
+            }
+            position_++;
+            skip_blanks(false);
+        }
+        const auto result = std::from_chars(position_, end_, values[column]);
+        if (result.ec != std::errc()) {
+            fail("invalid number");
+        }
+        position_ = result.ptr;
+    }
+    end_line();
+}
+
+void TextModel::skip_blanks(bool skip_lines) {
+    while (position_ != end_ &&
+           (*position_ == ' ' || *position_ == '\t' || *position_ == '\r' || (skip_lines && *position_ == '\n'))) {
+        if (*position_ == '\n') {
+            line_++;
+        }
+        position_++;
+    }
+}
+
+void TextModel::end_line() {
+    skip_blanks(false);
+    if (position_ != end_) {
+        if (*position_ != '\n') {
+            fail("unexpected characters at end of line");
+        }
+        position_++;
+        line_++;
+    }
+}
+
+void TextModel::fail(const std::string& what) const {
+    throw std::runtime_error("invalid model, line " + std::to_string(line_) + ": " + what);
+}
@@ -0,0 +1,70 @@
+#ifndef PROJET_BIOINFO_WIRTH_TEXTMODEL_H
+#define PROJET_BIOINFO_WIRTH_TEXTMODEL_H
+
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include "Matrix.h"
+
+/**
+ * Lecture du format texte des fichiers modèle (celui qu'écrit HMM-build), directement dans le fichier projeté, sans
+ * copie ni chaîne temporaire : les nombres sont lus par std::from_chars.
+ * Un modèle : une ligne '>nom' facultative, N, puis les lignes de T (N x 9), e_M (N x 20, la première à nan) et e_I
+ * (N x 20). Les valeurs d'une ligne sont séparées par des virgules, de largeur quelconque ; "nan" est accepté. Une
+ * bibliothèque est une suite de modèles dans le même fichier.
+ * Toute erreur (nombre mal formé, ligne trop courte ou trop longue, ligne manquante) lève std::runtime_error, avec le
+ * numéro de la ligne fautive.
+ */
+class TextModel {
+public:
+    /**
+     * @param begin début du texte à lire
+     * @param end fin du texte
+     */
+    TextModel(const char *begin, const char *end);
+
+    // Vrai s'il ne reste que des blancs (fin de la bibliothèque)
+    bool at_end();
+    // Position de lecture, après le dernier élément lu
+    [[nodiscard]] const char *position() const { return position_; }
+
+    /**
+     * Ligne '>nom' facultative précédant un modèle
+     * @return le nom (sans le '>' ni les blancs qui l'entourent), sans valeur s'il n'y en a pas
+     */
+    std::optional<std::string> name();
+
+    /**
+     * @return N, le nombre de rangs du modèle (au moins 1)
+     */
+    std::size_t size();
+
+    /**
+     * Lecture de matrix.rows() lignes de Columns valeurs
+     * @param matrix la matrice à remplir, déjà dimensionnée
+     */
+    template <std::size_t Columns>
+    void read_matrix(Matrix<Columns>& matrix) {
+        for (std::size_t row = 0; row < matrix.rows(); row++) {
+            read_row(matrix[row], Columns);
+        }
+    }
+
+private:
+    // Lecture d'une ligne de columns valeurs séparées par des virgules
+    void read_row(float *values, std::size_t columns);
+    // Saute les espaces et tabulations (skip_lines : les fins de ligne aussi)
+    void skip_blanks(bool skip_lines);
+    // Fin de ligne attendue (ou fin du texte)
+    void end_line();
+    [[noreturn]] void fail(const std::string& what) const;
+
+    const char *position_;
+    const char *end_;
+    // Numéro de la ligne courante, pour les messages d'erreur
+    std::size_t line_ = 1;
+};
+
+
+#endif //PROJET_BIOINFO_WIRTH_TEXTMODEL_H
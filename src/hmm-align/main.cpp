@@ -4,19 +4,87 @@
 
 #include <cstring>
 #include <iostream>
+#include <string>
+#include <vector>
+#include "../HMM/Batch.h"
 #include "../HMM/HMM.h"
+#include "../HMM/Output.h"
+#include "../HMM/Stats.h"
 
 int main(int argc, char *argv[]) {
-    bool score = false;
-    int begin = 1;
+    HMM::AlignOptions options;
+    // Mode batch : aligner tous les enregistrements du fasta, et non uniquement le dernier
+    bool batch = false;
+    // --format : format des résultats du mode batch (voir Batch::run)
+    Output::Format format = Output::Format::text;
+    unsigned threads = 0;
+    std::vector<char *> arguments;
     for (int i = 1; i < argc; i++) {
         if (!strcmp(argv[i], "--score")) {
-            score = true;
-            begin = i + 1;
+            options.score = true;
+        } else if (!strcmp(argv[i], "--posterior")) {
+            options.posterior = true;
+        } else if (!strcmp(argv[i], "--local")) {
+            options.mode = HMM::Mode::local;
+        } else if (!strcmp(argv[i], "--glocal")) {
+            options.mode = HMM::Mode::glocal;
+        } else if (!strcmp(argv[i], "--multiple")) {
+            options.multiple = true;
+        } else if (!strcmp(argv[i], "--integer")) {
+            options.integer = true;
+        } else if (!strcmp(argv[i], "--batch")) {
+            batch = true;
+        } else if (!strcmp(argv[i], "--stats")) {
+            Stats::enable();
+        } else if (!strcmp(argv[i], "--band") && i + 1 < argc) {
+            options.band = std::stoul(argv[++i]);
+        } else if (!strcmp(argv[i], "--format") && i + 1 < argc) {
+            auto parsed = Output::parse_format(argv[++i]);
+            if (not parsed.has_value()) {
+                return 1;
+            }
+            format = parsed.value();
+        } else if (!strcmp(argv[i], "--threads") && i + 1 < argc) {
+            threads = std::stoul(argv[++i]);
+        } else if (!strcmp(argv[i], "--max-memory") && i + 1 < argc) {
+            // En Mo, ou en Ko avec le suffixe K
+            std::size_t end;
+            options.max_memory = std::stoull(argv[++i], &end);
+            options.max_memory <<= argv[i][end] == 'K' ? 10 : 20;
+        } else {
+            arguments.push_back(argv[i]);
         }
     }
-    HMM hmm(argv[begin]);
-    hmm.set_sequences(Fasta(argv[begin + 1]).parse());
-    hmm.viterbi(score);
+    if (arguments.size() < 2) {
+        return 1;
+    }
+    try {
+        HMM::check_options(options);
+        HMM hmm(arguments[0]);
+        Fasta fasta(arguments[1]);
+        if (batch) {
+            Batch(hmm, threads).run(fasta, options, format, std::cout);
+        } else {
+            // Seule la dernière séquence est alignée : inutile de copier les autres
+            std::vector<char> sequence;
+            {
+                Stats::Timer timer(Stats::Stage::parse);
+                for (const auto & record : fasta) {
+                    sequence.clear();
+                    record.copy_residues(sequence);
+                    Stats::add(Stats::Counter::sequences, 1);
+                }
+            }
+            Output(std::cout) << hmm.align(sequence, options);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << arguments[0] << ": " << e.what() << std::endl;
+        return 1;
+    }
+    // --stats : mesures de l'exécution, en JSON sur la sortie d'erreur (voir Stats)
+    if (Stats::enabled()) {
+        std::cout.flush();
+        Stats::report(std::cerr);
+    }
     return 0;
-}
\ No newline at end of file
+}
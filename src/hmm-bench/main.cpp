@@ -0,0 +1,240 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include "../HMM/Alphabet.h"
+#include "../HMM/Fasta.h"
+#include "../HMM/HMM.h"
+#include "../HMM/Output.h"
+#include "../HMM/Random.h"
+#include "../HMM/Stats.h"
+#include "../HMM/Striped.h"
+
+namespace {
+
+// Durée minimale d'une mesure : les cas rapides sont répétés jusqu'à l'atteindre
+constexpr double minimum_seconds = 0.2;
+// Destination des scores calculés, pour que les calculs ne soient pas éliminés
+volatile float sink;
+
+// Remise à zéro du pic de mémoire résidente (Linux : VmHWM), pour mesurer celui de chaque cas
+void reset_peak_rss() {
+    std::ofstream("/proc/self/clear_refs") << "5";
+}
+
+/**
+ * Cas de mesure : une ligne de résultat JSON
+ */
+struct Result {
+    std::string name;
+    // Dimensions (0 si sans objet) : rangs du modèle, longueur des séquences, séquences de l'alignement
+    std::size_t N = 0;
+    std::size_t L = 0;
+    std::size_t rows = 0;
+    double seconds = 0;
+    // Cases calculées (N x L pour un alignement, lignes x colonnes pour une construction) et enregistrements traités
+    double cells = 0;
+    double records = 0;
+    // Pic de mémoire résidente pendant la mesure, en Ko
+    long peak_rss_kb = 0;
+};
+
+// Exécute run jusqu'à ce que minimum_seconds soient écoulées (au moins une fois) : durée moyenne d'une exécution et pic
+// de mémoire dans result
+template <class Run>
+void measure(Result& result, Run run) {
+    reset_peak_rss();
+    using clock = std::chrono::steady_clock;
+    const auto start = clock::now();
+    std::size_t runs = 0;
+    double elapsed = 0;
+    do {
+        run();
+        runs++;
+        elapsed = std::chrono::duration<double>(clock::now() - start).count();
+    } while (elapsed < minimum_seconds);
+    result.seconds = elapsed / static_cast<double>(runs);
+    // Pic depuis la remise à zéro (à défaut, depuis le lancement du processus)
+    result.peak_rss_kb = Stats::peak_rss_kb();
+}
+
+// Séquence aléatoire de length acides aminés équiprobables
+std::string random_residues(Random& random, std::size_t length) {
+    std::string residues(length, 'A');
+    for (auto & residue : residues) {
+        residue = Alphabet::residue(((random.next() >> 32) * Alphabet::size) >> 32);
+    }
+    return residues;
+}
+
+// Alignement synthétique de rows séquences de width colonnes : une colonne sur 5 est majoritairement faite de gaps
+// (état I à alpha 0.5) si gappy, les autres en ont 10 %
+void write_alignment(const std::string& filename, Random& random, std::size_t rows, std::size_t width, bool gappy) {
+    std::ofstream file(filename, std::ios::binary);
+    std::string row(width, '-');
+    for (std::size_t i = 0; i < rows; i++) {
+        for (std::size_t column = 0; column < width; column++) {
+            const double gaps = gappy && column % 5 == 4 ? 0.7 : 0.1;
+            const double u = static_cast<double>(random.next() >> 11) * 0x1p-53;
+            row[column] = u < gaps ? '-' : Alphabet::residue(((random.next() >> 32) * Alphabet::size) >> 32);
+        }
+        file << ">s" << i << '\n' << row << '\n';
+    }
+}
+
+void write_result(Output& out, const Result& result, bool first) {
+    out << (first ? "\n    " : ",\n    ") << "{\"name\":";
+    out.json(result.name);
+    out << ",\"N\":" << result.N << ",\"L\":" << result.L << ",\"rows\":" << result.rows;
+    out.precision(6);
+    out << ",\"seconds\":";
+    out.json(result.seconds);
+    out << ",\"gcups\":";
+    out.json(result.cells / result.seconds / 1e9);
+    out << ",\"records_per_second\":";
+    out.json(result.records / result.seconds);
+    out.precision(3);
+    out << ",\"peak_rss_kb\":" << result.peak_rss_kb << '}';
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    // --quick : petites tailles seulement (vérification rapide)
+    bool quick = false;
+    unsigned threads = 0;
+    std::uint64_t seed = 0;
+    std::string output;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--quick")) {
+            quick = true;
+        } else if (!strcmp(argv[i], "--threads") && i + 1 < argc) {
+            threads = std::stoul(argv[++i]);
+        } else if (!strcmp(argv[i], "--seed") && i + 1 < argc) {
+            seed = std::stoull(argv[++i]);
+        } else if (!strcmp(argv[i], "--output") && i + 1 < argc) {
+            output = argv[++i];
+        } else {
+            std::cerr << "usage: " << argv[0] << " [--quick] [--threads n] [--seed s] [--output file.json]" << std::endl;
+            return 1;
+        }
+    }
+    threads = threads != 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+    // Tailles mesurées
+    const std::vector<std::size_t> model_sizes = quick ? std::vector<std::size_t>{10, 100} :
+            std::vector<std::size_t>{10, 100, 500, 2000};
+    const std::vector<std::size_t> lengths = quick ? std::vector<std::size_t>{50, 500} :
+            std::vector<std::size_t>{50, 500, 5000, 50000};
+    // Alignements de HMM-build : (séquences, colonnes)
+    const std::vector<std::pair<std::size_t, std::size_t>> alignments = quick ?
+            std::vector<std::pair<std::size_t, std::size_t>>{{1000, 100}} :
+            std::vector<std::pair<std::size_t, std::size_t>>{{1000, 2000}, {100000, 200}, {1000000, 100}};
+    const std::size_t samples = quick ? 10000 : 100000;
+
+    const auto directory = std::filesystem::temp_directory_path() / ("hmm-bench-" + std::to_string(getpid()));
+    std::filesystem::create_directories(directory);
+    Random random(seed);
+    std::vector<Result> results;
+    try {
+        // HMM-build : lecture du fasta, colonnes marquées et comptes
+        for (auto [rows, width] : alignments) {
+            const std::string fasta = (directory / "build.fasta").string();
+            write_alignment(fasta, random, rows, width, true);
+            Result result{"build", 0, 0, rows};
+            measure(result, [&]() {
+                HMM::build_models(Fasta(fasta), {0.5f}, threads);
+            });
+            result.cells = static_cast<double>(rows * width);
+            result.records = static_cast<double>(rows);
+            results.push_back(result);
+            std::filesystem::remove(fasta);
+        }
+        for (std::size_t N : model_sizes) {
+            // Modèle à N rangs : alignement de N - 1 colonnes, toutes marquées
+            const std::string fasta = (directory / "model.fasta").string();
+            const std::string model_file = (directory / "bench.model").string();
+            write_alignment(fasta, random, 100, N - 1, false);
+            {
+                std::ofstream model(model_file);
+                HMM::build_models(Fasta(fasta), {0.5f}, threads).front().print_model(model);
+            }
+            Result load{"load", N};
+            measure(load, [&]() {
+                HMM loaded(model_file);
+            });
+            load.records = 1;
+            results.push_back(load);
+            const HMM hmm(model_file);
+
+            for (std::size_t L : lengths) {
+                const std::string text = random_residues(random, L);
+                const std::vector<char> sequence(text.begin(), text.end());
+                std::vector<std::uint8_t> residues;
+                for (char c : text) {
+                    residues.push_back(Alphabet::digitize(c));
+                }
+                const double cells = static_cast<double>(N * L);
+                // Score seul (moteur vectorisé), puis alignement complet (matrice et étape retour)
+                Result score{"align_score", N, L};
+                HMM::AlignOptions options;
+                options.score = true;
+                measure(score, [&]() {
+                    sink = hmm.score(residues, options);
+                });
+                score.cells = cells;
+                score.records = 1;
+                results.push_back(score);
+                // Score seul sur entiers 16 bits (recalculé en flottants s'il sature)
+                Result integer{"align_score_int16", N, L};
+                options.integer = true;
+                measure(integer, [&]() {
+                    sink = hmm.score(residues, options);
+                });
+                integer.cells = cells;
+                integer.records = 1;
+                results.push_back(integer);
+                Result full{"align_full", N, L};
+                measure(full, [&]() {
+                    sink = hmm.align_sequence(sequence, HMM::AlignOptions{}).score;
+                });
+                full.cells = cells;
+                full.records = 1;
+                results.push_back(full);
+            }
+
+            // HMM-genseq --sample, texte écrit dans un flux sans tampon (ignoré)
+            Result genseq{"genseq_sample", N, 0, samples};
+            std::ostream discard(nullptr);
+            measure(genseq, [&]() {
+                hmm.sample_genseq(samples, seed, threads, discard);
+            });
+            genseq.records = static_cast<double>(samples);
+            results.push_back(genseq);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << argv[0] << ": " << e.what() << std::endl;
+        std::filesystem::remove_all(directory);
+        return 1;
+    }
+    std::filesystem::remove_all(directory);
+
+    std::ofstream file;
+    if (not output.empty()) {
+        file.open(output);
+    }
+    Output out(output.empty() ? std::cout : file);
+    const char *isa[] = {"scalar", "sse4.1", "avx2"};
+    out << "{\"quick\":" << (quick ? "true" : "false") << ",\"threads\":" << threads << ",\"seed\":" << seed
+        << ",\"isa\":\"" << isa[static_cast<int>(Striped::detect())] << "\",\"results\":[";
+    for (std::size_t i = 0; i < results.size(); i++) {
+        write_result(out, results[i], i == 0);
+    }
+    out << "\n]}\n";
+    return 0;
+}
@@ -2,18 +2,81 @@
 // Created by felix on 08/07/22.
 //
 
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
 #include <vector>
 #include "../HMM/Fasta.h"
 #include "../HMM/HMM.h"
+#include "../HMM/Stats.h"
 
 int main(int argc, char *argv[]) {
-    if (argc < 3) {
+    // --binary : écrire le modèle au format binaire, plutôt que texte
+    bool binary = false;
+    unsigned threads = 0;
+    // --output : préfixe des fichiers écrits (un par alpha)
+    std::string output;
+    std::vector<char *> arguments;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--binary")) {
+            binary = true;
+        } else if (!strcmp(argv[i], "--stats")) {
+            Stats::enable();
+        } else if (!strcmp(argv[i], "--threads") && i + 1 < argc) {
+            threads = std::stoul(argv[++i]);
+        } else if (!strcmp(argv[i], "--output") && i + 1 < argc) {
+            output = argv[++i];
+        } else {
+            arguments.push_back(argv[i]);
+        }
+    }
+    if (arguments.size() < 2) {
+        return 1;
+    }
+    std::vector<float> alphas;
+    for (std::size_t i = 1; i < arguments.size(); i++) {
+        alphas.push_back(static_cast<float>(std::atof(arguments[i])));
+    }
+    try {
+        const std::vector<HMM> models = HMM::build_models(Fasta(arguments[0]), alphas, threads);
+        // Un seul alpha sans --output : le modèle est écrit sur la sortie standard
+        if (alphas.size() == 1 && output.empty()) {
+            if (binary) {
+                models.front().print_binary_model(std::cout);
+            } else {
+                models.front().print_model(std::cout);
+            }
+        } else {
+            // Sinon, un fichier par alpha : préfixe_alpha.model, le préfixe étant par défaut le nom du fasta sans
+            // répertoire ni extension
+            if (output.empty()) {
+                output = arguments[0];
+                output = output.substr(output.find_last_of('/') + 1);
+                output = output.substr(0, output.find_last_of('.'));
+            }
+            for (std::size_t i = 0; i < models.size(); i++) {
+                const std::string filename = output + "_" + arguments[i + 1] + ".model";
+                std::ofstream file(filename, std::ios::binary);
+                if (!file) {
+                    throw std::runtime_error("cannot open " + filename);
+                }
+                if (binary) {
+                    models[i].print_binary_model(file);
+                } else {
+                    models[i].print_model(file);
+                }
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << arguments[0] << ": " << e.what() << std::endl;
         return 1;
     }
-    HMM hmm(Fasta(argv[1]), std::atof(argv[2]));
-    hmm.build_model();
-    hmm.print_model();
+    // --stats : mesures de l'exécution, en JSON sur la sortie d'erreur (voir Stats)
+    if (Stats::enabled()) {
+        std::cout.flush();
+        Stats::report(std::cerr);
+    }
     return 0;
 }
-
-
@@ -0,0 +1,68 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "../HMM/Server.h"
+
+int main(int argc, char *argv[]) {
+    // --repeat n : envoyer n fois la requête donnée, et écrire la durée moyenne d'un aller-retour sur la sortie d'erreur
+    std::size_t repeat = 1;
+    std::vector<std::string> arguments;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--repeat") && i + 1 < argc) {
+            repeat = std::max<std::size_t>(1, std::stoull(argv[++i]));
+        } else {
+            arguments.emplace_back(argv[i]);
+        }
+    }
+    if (arguments.empty() || arguments.size() > 2) {
+        std::cerr << "usage: " << argv[0] << " [--repeat n] socket [request]" << std::endl;
+        return 1;
+    }
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, arguments[0].c_str(), sizeof(address.sun_path) - 1);
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0) {
+        std::cerr << argv[0] << ": cannot connect to " << arguments[0] << std::endl;
+        return 1;
+    }
+    Server::Channel channel(fd, fd);
+    std::string response;
+    // Sans requête en argument : une requête par ligne de l'entrée standard, chaque réponse écrite sur la sortie
+    if (arguments.size() == 1) {
+        std::string request;
+        while (std::getline(std::cin, request)) {
+            if (not channel.write(request + '\n')) {
+                break;
+            }
+            if (request == "quit" || not channel.read_line(response)) {
+                break;
+            }
+            std::cout << response << '\n';
+        }
+        close(fd);
+        return 0;
+    }
+    const std::string request = arguments[1] + '\n';
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < repeat; i++) {
+        if (not channel.write(request) || not channel.read_line(response)) {
+            std::cerr << argv[0] << ": connection closed" << std::endl;
+            close(fd);
+            return 1;
+        }
+    }
+    const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << response << '\n';
+    if (repeat > 1) {
+        std::cerr << "mean round trip: " << elapsed.count() / static_cast<double>(repeat) << " us" << std::endl;
+    }
+    close(fd);
+    return response.compare(0, 2, "ok") == 0 ? 0 : 1;
+}
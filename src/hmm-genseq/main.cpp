@@ -3,14 +3,53 @@
 //
 
 
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
 #include "../HMM/HMM.h"
+#include "../HMM/Output.h"
+#include "../HMM/Stats.h"
 
 int main(int argc, char *argv[]) {
+    // --sample n : tirer n séquences au hasard selon le modèle, plutôt que la séquence la plus probable
+    std::size_t count = 0;
+    std::uint64_t seed = 0;
+    unsigned threads = 0;
+    std::vector<char *> arguments;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--sample") && i + 1 < argc) {
+            count = std::stoull(argv[++i]);
+        } else if (!strcmp(argv[i], "--seed") && i + 1 < argc) {
+            seed = std::stoull(argv[++i]);
+        } else if (!strcmp(argv[i], "--stats")) {
+            Stats::enable();
+        } else if (!strcmp(argv[i], "--threads") && i + 1 < argc) {
+            threads = std::stoul(argv[++i]);
+        } else {
+            arguments.push_back(argv[i]);
+        }
+    }
     // Ne devrait pas arriver, les inputs sont "valides"
-    if (argc < 2) {
+    if (arguments.empty()) {
+        return 1;
+    }
+    try {
+        HMM hmm(arguments[0]);
+        if (count != 0) {
+            hmm.sample_genseq(count, seed, threads, std::cout);
+        } else {
+            const HMM::Alignment genseq = hmm.most_probable_sequence();
+            Output(std::cout) << genseq.sequence << '\n' << genseq.states << '\n';
+        }
+    } catch (const std::exception& e) {
+        std::cerr << arguments[0] << ": " << e.what() << std::endl;
         return 1;
     }
-    HMM hmm(argv[1]);
-    hmm.build_print_genseq();
+    // --stats : mesures de l'exécution, en JSON sur la sortie d'erreur (voir Stats)
+    if (Stats::enabled()) {
+        std::cout.flush();
+        Stats::report(std::cerr);
+    }
     return 0;
 }
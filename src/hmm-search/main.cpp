@@ -0,0 +1,68 @@
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../HMM/Search.h"
+#include "../HMM/Stats.h"
+
+int main(int argc, char *argv[]) {
+    Search::Options options;
+    unsigned threads = 0;
+    std::vector<std::string> arguments;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--posterior")) {
+            options.align.posterior = true;
+        } else if (!strcmp(argv[i], "--stats")) {
+            Stats::enable();
+        } else if (!strcmp(argv[i], "--local")) {
+            options.align.mode = HMM::Mode::local;
+        } else if (!strcmp(argv[i], "--glocal")) {
+            options.align.mode = HMM::Mode::glocal;
+        } else if (!strcmp(argv[i], "--multiple")) {
+            options.align.multiple = true;
+        } else if (!strcmp(argv[i], "--integer")) {
+            options.align.integer = true;
+        } else if (!strcmp(argv[i], "--band") && i + 1 < argc) {
+            options.align.band = std::stoul(argv[++i]);
+        } else if (!strcmp(argv[i], "--format") && i + 1 < argc) {
+            auto parsed = Output::parse_format(argv[++i]);
+            if (not parsed.has_value()) {
+                return 1;
+            }
+            options.format = parsed.value();
+        } else if (!strcmp(argv[i], "--threads") && i + 1 < argc) {
+            threads = std::stoul(argv[++i]);
+        } else if (!strcmp(argv[i], "--prefilter") && i + 1 < argc) {
+            options.prefilter = std::stof(argv[++i]);
+        } else if (!strcmp(argv[i], "--threshold") && i + 1 < argc) {
+            options.threshold = std::stof(argv[++i]);
+        } else {
+            arguments.emplace_back(argv[i]);
+        }
+    }
+    // Au moins un modèle, puis la base de séquences
+    if (arguments.size() < 2) {
+        return 1;
+    }
+    try {
+        HMM::check_options(options.align);
+        Fasta fasta(arguments.back());
+        arguments.pop_back();
+        auto counts = Search(arguments, threads).run(fasta, options, std::cout);
+        // Nombre de couples passés à chaque étape, pour régler les seuils
+        if (options.prefilter.has_value()) {
+            std::cerr << "pairs\t" << counts.pairs << std::endl;
+            std::cerr << "prefilter\t" << counts.prefilter << std::endl;
+            std::cerr << "reported\t" << counts.reported << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << argv[0] << ": " << e.what() << std::endl;
+        return 1;
+    }
+    // --stats : mesures de l'exécution, en JSON sur la sortie d'erreur (voir Stats)
+    if (Stats::enabled()) {
+        std::cout.flush();
+        Stats::report(std::cerr);
+    }
+    return 0;
+}
@@ -0,0 +1,55 @@
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <pthread.h>
+#include <unistd.h>
+#include "../HMM/Server.h"
+
+int main(int argc, char *argv[]) {
+    // --socket : chemin de la socket Unix ; sans socket, les requêtes sont lues sur l'entrée standard
+    std::string socket_path;
+    unsigned threads = 0;
+    std::vector<std::string> arguments;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--socket") && i + 1 < argc) {
+            socket_path = argv[++i];
+        } else if (!strcmp(argv[i], "--threads") && i + 1 < argc) {
+            threads = std::stoul(argv[++i]);
+        } else {
+            arguments.emplace_back(argv[i]);
+        }
+    }
+    if (arguments.empty()) {
+        std::cerr << "usage: " << argv[0] << " [--socket path] [--threads n] model [model...]" << std::endl;
+        return 1;
+    }
+    // Un client déconnecté ne doit pas arrêter le serveur : l'écriture échoue simplement
+    std::signal(SIGPIPE, SIG_IGN);
+    try {
+        Server server(arguments, threads);
+        if (socket_path.empty()) {
+            Server::Channel channel(STDIN_FILENO, STDOUT_FILENO);
+            server.serve(channel);
+            return 0;
+        }
+        // SIGINT et SIGTERM sont attendus par un thread dédié (bloqués dans tous les autres), qui arrête le serveur
+        sigset_t signals;
+        sigemptyset(&signals);
+        sigaddset(&signals, SIGINT);
+        sigaddset(&signals, SIGTERM);
+        pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+        std::thread([&server, signals]() {
+            int signal;
+            sigwait(&signals, &signal);
+            server.stop();
+        }).detach();
+        server.listen(socket_path);
+    } catch (const std::exception& e) {
+        std::cerr << argv[0] << ": " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}